@@ -135,7 +135,7 @@ read_ansi(void)
 {
     int ch, i, j, last_escape;
 
-    fflush(stdout);
+    flush_output();
     read_key((char *) ansi_buf, sizeof(ansi_buf));
     /* Throw away control characters inside CSI sequences.
        Convert two character 7-bit sequences into 8-bit sequences. */
@@ -0,0 +1,147 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+
+#include <tack.h>
+
+MODULE_ID("$Id: arena.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Arena allocation.
+ *
+ * Most of what tack allocates lasts until it exits: arrays sized by the
+ * number of caps, the index of the tests which use each cap, the names read
+ * from infocmp.  Those are allocated from the session arena, and freed
+ * together when tack exits.
+ *
+ * The pad test results are allocated from the results arena, which is reset
+ * at the start of each test run, so that repeated runs reuse its memory
+ * rather than growing.
+ */
+
+#define ARENA_CHUNK	16384	/* bytes in a normal chunk */
+
+typedef union {
+    long a_long;
+    double a_double;
+    void *a_pointer;
+} ArenaAlign;
+
+struct _arena_chunk {
+    ArenaChunk *next;		/* next older chunk */
+    size_t size;		/* bytes available in data[] */
+    size_t used;		/* bytes allocated from data[] */
+    ArenaAlign data[1];
+};
+
+Arena session_arena;		/* freed when tack exits */
+Arena results_arena;		/* reset for each test run */
+
+/*
+**	arena_alloc(arena, size)
+**
+**	Return zeroed memory from the arena.  Exit if there is none.
+*/
+void *
+arena_alloc(
+	       Arena * arena,
+	       size_t size)
+{
+    ArenaChunk *chunk = arena->chunks;
+    char *result;
+
+    size = ((size + sizeof(ArenaAlign) - 1) / sizeof(ArenaAlign))
+	* sizeof(ArenaAlign);
+    if (chunk == NULL || chunk->used + size > chunk->size) {
+	size_t want = (size > ARENA_CHUNK) ? size : ARENA_CHUNK;
+
+	if ((chunk = (ArenaChunk *) malloc(sizeof(ArenaChunk) + want)) == NULL) {
+	    fprintf(stderr, "tack: out of memory\n");
+	    ExitProgram(EXIT_FAILURE);
+	}
+	chunk->next = arena->chunks;
+	chunk->size = want;
+	chunk->used = 0;
+	arena->chunks = chunk;
+    }
+    result = (char *) chunk->data + chunk->used;
+    chunk->used += size;
+    memset(result, 0, size);
+    return (void *) result;
+}
+
+/*
+**	arena_strdup(arena, string)
+**
+**	Return a copy of the string, allocated from the arena.
+*/
+char *
+arena_strdup(
+		Arena * arena,
+		const char *s)
+{
+    char *result = (char *) arena_alloc(arena, strlen(s) + 1);
+
+    strcpy(result, s);
+    return result;
+}
+
+/*
+**	arena_reset(arena)
+**
+**	Discard everything allocated from the arena, keeping its oldest chunk
+**	to reuse.
+*/
+void
+arena_reset(
+	       Arena * arena)
+{
+    ArenaChunk *chunk;
+
+    while ((chunk = arena->chunks) != NULL && chunk->next != NULL) {
+	arena->chunks = chunk->next;
+	free(chunk);
+    }
+    if (chunk != NULL) {
+	chunk->used = 0;
+    }
+}
+
+/*
+**	arena_free(arena)
+**
+**	Discard everything allocated from the arena, and the arena's memory.
+*/
+void
+arena_free(
+	      Arena * arena)
+{
+    arena_reset(arena);
+    FreeIfNeeded(arena->chunks);
+}
+
+#if NO_LEAKS
+void
+tack_arena_leaks(void)
+{
+    arena_free(&results_arena);
+    arena_free(&session_arena);
+}
+#endif
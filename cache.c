@@ -0,0 +1,293 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+#include <tack.h>
+
+#include <time.h>
+
+MODULE_ID("$Id: cache.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Persistent cache of pad test results.
+ *
+ * Each result is appended to the cache file as one line of tab-separated
+ * fields:
+ *
+ *	identity cap value time usec characters cps reps delay
+ *
+ * The identity is the terminal name followed by the terminal's replies to
+ * the ENQ (u9), RV and XR requests.  The identity and the cap value are
+ * written with every byte outside the printable ASCII range (and the
+ * backslash) shown as \xHH, so that they compare exactly.  The time is in
+ * seconds since the epoch, so the file is also a history of the results.
+ *
+ * When the cache is read, a later line for the same identity, cap and
+ * value replaces an earlier one.
+ */
+
+#define CACHE_MAGIC	"# tack result cache"
+#define CACHE_FIELDS	9
+
+typedef struct _cache_entry {
+    struct _cache_entry *next;
+    char *ident;		/* escaped terminal identity */
+    char *cap;			/* cap name */
+    char *value;		/* escaped cap value */
+    int reps;			/* repeat count */
+    int delay;			/* delay in microseconds per operation */
+} CacheEntry;
+
+static FILE *cache_fp;		/* cache file, opened for appending */
+static CacheEntry *cache_list;	/* results read from the cache file */
+static char *cache_ident;	/* escaped identity of this terminal */
+
+/*
+**	cache_escape(text)
+**
+**	Return an allocated copy of the text with non-printing characters,
+**	tabs and backslashes written as \xHH.
+*/
+static char *
+cache_escape(const char *text)
+{
+    char *result = (char *) malloc((strlen(text) * 4) + 1);
+
+    if (result != NULL) {
+	char *d = result;
+
+	while (*text != '\0') {
+	    int ch = UChar(*text++);
+
+	    if (ch <= ' ' || ch >= 127 || ch == '\\') {
+		sprintf(d, "\\x%02X", ch);
+		d += 4;
+	    } else {
+		*d++ = (char) ch;
+	    }
+	}
+	*d = '\0';
+    }
+    return result;
+}
+
+/*
+**	cache_add(ident, cap, value, reps, delay)
+**
+**	Add a result to the in-memory list, replacing an older result for
+**	the same identity, cap and value.
+*/
+static void
+cache_add(
+	     const char *ident,
+	     const char *cap,
+	     const char *value,
+	     int reps,
+	     int delay)
+{
+    CacheEntry *p;
+
+    for (p = cache_list; p != NULL; p = p->next) {
+	if (!strcmp(p->cap, cap)
+	    && !strcmp(p->value, value)
+	    && !strcmp(p->ident, ident)) {
+	    break;
+	}
+    }
+    if (p == NULL) {
+	if ((p = (CacheEntry *) calloc((size_t) 1, sizeof(CacheEntry))) == NULL) {
+	    return;
+	}
+	p->ident = strdup(ident);
+	p->cap = strdup(cap);
+	p->value = strdup(value);
+	if (p->ident == NULL || p->cap == NULL || p->value == NULL) {
+	    FreeIfNeeded(p->ident);
+	    FreeIfNeeded(p->cap);
+	    FreeIfNeeded(p->value);
+	    free(p);
+	    return;
+	}
+	p->next = cache_list;
+	cache_list = p;
+    }
+    p->reps = reps;
+    p->delay = delay;
+}
+
+/*
+**	cache_open(filename)
+**
+**	Read the results from the cache file, and open it for appending.
+*/
+void
+cache_open(const char *filename)
+{
+    FILE *fp;
+    char line[TEMP_SIZE * 4];
+
+    if ((fp = fopen(filename, "r")) != NULL) {
+	while (fgets(line, (int) sizeof(line), fp) != NULL) {
+	    char *field[CACHE_FIELDS];
+	    char *s = line;
+	    int n;
+
+	    if (line[0] == '#') {
+		continue;
+	    }
+	    for (n = 0; n < CACHE_FIELDS; n++) {
+		field[n] = s;
+		if ((s = strpbrk(s, "\t\n")) == NULL) {
+		    break;
+		}
+		*s++ = '\0';
+	    }
+	    if (n >= CACHE_FIELDS - 1) {
+		cache_add(field[0], field[1], field[2],
+			  atoi(field[7]), atoi(field[8]));
+	    }
+	}
+	fclose(fp);
+    }
+    if ((cache_fp = fopen(filename, "a")) == NULL) {
+	perror(filename);
+	ExitProgram(EXIT_FAILURE);
+    }
+    if (ftell(cache_fp) == 0) {
+	fprintf(cache_fp, "%s\n", CACHE_MAGIC);
+    }
+}
+
+/*
+**	cache_close()
+**
+**	Close the cache file and discard the results read from it.
+*/
+void
+cache_close(void)
+{
+    if (cache_fp) {
+	fclose(cache_fp);
+	cache_fp = NULL;
+    }
+    while (cache_list != NULL) {
+	CacheEntry *next = cache_list->next;
+
+	free(cache_list->ident);
+	free(cache_list->cap);
+	free(cache_list->value);
+	free(cache_list);
+	cache_list = next;
+    }
+    FreeIfNeeded(cache_ident);
+}
+
+/*
+**	cache_identity()
+**
+**	Return the escaped identity of the terminal, asking the terminal for
+**	it the first time.  Return null if the timing results cannot be
+**	trusted, i.e., the terminal does not synchronize.
+*/
+static const char *
+cache_identity(void)
+{
+    if (cache_ident == NULL && tty_can_sync == SYNC_TESTED) {
+	char buf[TEMP_SIZE];
+	size_t len;
+
+	sprintf(buf, "%.*s;", NAME_SIZE, tty_basename);
+	len = strlen(buf);
+	tty_identity(buf + len, sizeof(buf) - len);
+	cache_ident = cache_escape(buf);
+    }
+    return cache_ident;
+}
+
+/*
+**	cache_lookup(cap, value, reps, delay)
+**
+**	Look for a result for this terminal and cap value.
+**	Return TRUE if one is found.
+*/
+int
+cache_lookup(
+		const char *cap,
+		const char *value,
+		int *reps,
+		int *delay)
+{
+    int result = FALSE;
+    const char *ident;
+
+    if (cache_fp != NULL
+	&& VALID_STRING(value)
+	&& (ident = cache_identity()) != NULL) {
+	char *escaped = cache_escape(value);
+
+	if (escaped != NULL) {
+	    CacheEntry *p;
+
+	    for (p = cache_list; p != NULL; p = p->next) {
+		if (!strcmp(p->cap, cap)
+		    && !strcmp(p->value, escaped)
+		    && !strcmp(p->ident, ident)) {
+		    *reps = p->reps;
+		    *delay = p->delay;
+		    result = TRUE;
+		    break;
+		}
+	    }
+	    free(escaped);
+	}
+    }
+    return result;
+}
+
+/*
+**	cache_store(cap, value, reps, delay)
+**
+**	Append the result of the last pad test for the cap to the cache.
+*/
+void
+cache_store(
+	       const char *cap,
+	       const char *value,
+	       int reps,
+	       int delay)
+{
+    const char *ident;
+
+    if (cache_fp != NULL
+	&& VALID_STRING(value)
+	&& (ident = cache_identity()) != NULL) {
+	char *escaped = cache_escape(value);
+
+	if (escaped != NULL) {
+	    fprintf(cache_fp, "%s\t%s\t%s\t%ld\t%lu\t%d\t%lu\t%d\t%d\n",
+		    ident, cap, escaped,
+		    (long) time((time_t *) 0),
+		    usec_run_time, tx_characters, tx_cps,
+		    reps, delay);
+	    fflush(cache_fp);
+	    cache_add(ident, cap, escaped, reps, delay);
+	    free(escaped);
+	}
+    }
+}
@@ -216,6 +216,144 @@ charset_dsl(
     generic_done_message(t, state, ch);
 }
 
+static const char status_prompt[] = "The cursor should stay here:";
+
+/*
+**	status_run(test_list, length, clear)
+**
+**	Write the status line over and over with (tsl) text (fsl), and with
+**	(dsl) after each update if clear is set, until the test time runs
+**	out.  Return the number of updates.
+*/
+static int
+status_run(
+	      TestList * t,
+	      int length,
+	      int clear)
+{
+    int updates = 0;
+    char text[TEMP_SIZE];
+
+    pad_test_startup(1);
+    /* the model does not know where the status line is */
+    model_forget();
+    put_str(status_prompt);
+    do {
+	int n;
+
+	sprintf(text, "%06d ", updates);
+	for (n = (int) strlen(text); n < length; n++) {
+	    text[n] = (char) letter;
+	}
+	text[length] = '\0';
+	tt_putparm(to_status_line, 1, 0, 0);
+	for (n = 0; n < length; n++) {
+	    put_this(text[n]);
+	}
+	tt_putp(from_status_line);
+	if (clear) {
+	    tt_putp(dis_status_line);
+	}
+	updates++;
+	if ((updates % 100) == 0) {
+	    NEXT_LETTER;
+	}
+	SLOW_TERMINAL_EXIT;
+    } while (still_testing());
+    pad_test_shutdown(t, 0);
+    return updates;
+}
+
+#define STATUS_RUNS	4	/* lengths tried, then with (dsl) */
+
+/*
+**	charset_status_rate(test_list, status, ch)
+**
+**	(tsl) (fsl) (dsl) time status line updates of different lengths.
+**	When verifying, check that the cursor on the main screen did not
+**	move.
+*/
+static void
+charset_status_rate(
+		       TestList * t,
+		       int *state,
+		       int *ch)
+{
+    int length[STATUS_RUNS];
+    int updates[STATUS_RUNS];
+    unsigned long usec[STATUS_RUNS];
+    int moved[STATUS_RUNS];
+    int runs, n, max, x;
+    char name[40];
+
+    if (has_status_line != 1 || !to_status_line || !from_status_line) {
+	ptext("(hs) (tsl) (fsl) There is no status line.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+    if (skip_pad_test(t, state, ch,
+		      "(tsl) (fsl) Start status line update test")) {
+	return;
+    }
+    max = width_status_line == -1 ? columns : width_status_line;
+    if (max >= TEMP_SIZE) {
+	max = TEMP_SIZE - 1;
+    }
+    length[0] = 8;
+    length[1] = 32;
+    length[2] = max;
+    length[3] = max;
+    runs = VALID_STRING(dis_status_line) ? STATUS_RUNS : STATUS_RUNS - 1;
+    for (n = 0; n < runs; n++) {
+	if (length[n] > max) {
+	    length[n] = max;
+	}
+	updates[n] = status_run(t, length[n], n == STATUS_RUNS - 1);
+	usec[n] = usec_run_time;
+	moved[n] = -1;
+	if (verify_mode) {
+	    int row, col;
+
+	    if (verify_cursor(&row, &col)) {
+		moved[n] = (row != 0 || col != (int) strlen(status_prompt));
+	    }
+	}
+    }
+    if (VALID_STRING(dis_status_line)) {
+	tc_putp(dis_status_line);
+    }
+    put_clear();
+    ptextln("status line            updates/sec  chars/sec  cursor");
+    for (n = 0; n < runs; n++) {
+	unsigned long divisor = usec[n] ? usec[n] : 1;
+
+	sprintf(name, "%d characters%s", length[n],
+		(n == STATUS_RUNS - 1) ? ", (dsl)" : "");
+	sprintf(temp, "%-22s %12lu %10lu  %s",
+		name,
+		(unsigned long) sliding_scale(updates[n], 1000000, divisor),
+		(unsigned long) sliding_scale(updates[n] * length[n],
+					      1000000, divisor),
+		(moved[n] < 0)
+		? "-"
+		: (moved[n] ? "*** moved" : "ok"));
+	ptextln(temp);
+    }
+    put_crlf();
+    /* the padding suggested for each cap, if the terminal synchronizes */
+    if ((x = get_string_cap_byvalue(to_status_line)) >= 0) {
+	show_cap_results(x);
+    }
+    if ((x = get_string_cap_byvalue(from_status_line)) >= 0) {
+	show_cap_results(x);
+    }
+    if (VALID_STRING(dis_status_line)
+	&& (x = get_string_cap_byvalue(dis_status_line)) >= 0) {
+	show_cap_results(x);
+    }
+    pad_done_message(t, state, ch);
+}
+
 void
 eat_cookie(void)
 {				/* put a blank if this is not a magic cookie
@@ -239,6 +377,9 @@ set_attr(int a)
 
     if (magic_cookie_glitch > 0) {
 	char_count += magic_cookie_glitch;
+    } else if (sgr_coalesce) {
+	sgr_attr(a);
+	return;
     }
     if (a == 0 && exit_attribute_mode) {
 	put_mode(exit_attribute_mode);
@@ -777,6 +918,294 @@ charset_enacs(
     }
 }
 
+/*****************************************************************************
+ *
+ * Line drawing throughput
+ *
+ *****************************************************************************/
+
+#define BOX_ACS		0	/* (smacs) (rmacs) around the line drawing */
+#define BOX_UTF8	1	/* UTF-8 box drawing characters instead */
+#define BOX_ENACS	2	/* (smacs) (rmacs), and (enacs) before each row */
+#define BOX_last	3
+
+#define BOX_WIDTHS	3	/* box widths which are tried */
+#define BOX_ENACS_WIDTH	1	/* the width used for the (enacs) run */
+
+/* the box drawing characters, by their (acsc) names */
+static const struct {
+    unsigned char c;
+    const char *utf8;
+} box_glyphs[] =
+{
+    {'l', "\342\224\214"},
+    {'k', "\342\224\220"},
+    {'m', "\342\224\224"},
+    {'j', "\342\224\230"},
+    {'q', "\342\224\200"},
+    {'x', "\342\224\202"},
+    {'t', "\342\224\234"},
+    {'u', "\342\224\244"},
+    {'w', "\342\224\254"},
+    {'v', "\342\224\264"},
+    {'n', "\342\224\274"}
+};
+
+static char box_acs[GLYPHS];	/* the character to send for each glyph */
+static const char *box_utf8[GLYPHS];
+static int box_switches;	/* times (smacs) was sent */
+static int box_rows;		/* rows drawn */
+
+/*
+**	box_prepare()
+**
+**	Look up the characters to send for the box drawing glyphs, using
+**	the VT100 characters if (acsc) does not say otherwise.
+*/
+static void
+box_prepare(void)
+{
+    int i;
+
+    for (i = 0; i < GLYPHS; i++) {
+	box_acs[i] = (char) i;
+	box_utf8[i] = NULL;
+    }
+    for (i = 0; i < (int) (sizeof(box_glyphs) / sizeof(box_glyphs[0])); i++) {
+	box_utf8[box_glyphs[i].c] = box_glyphs[i].utf8;
+    }
+    if (acs_chars) {
+	for (i = 0; acs_chars[i] && acs_chars[i + 1]; i += 2) {
+	    box_acs[UChar(acs_chars[i]) % GLYPHS] = acs_chars[i + 1];
+	}
+    }
+}
+
+/*
+**	box_char(row, col, used, width)
+**
+**	Return the glyph for a cell of a grid of boxes, or zero if the cell
+**	is inside a box.  Borders and rows of text alternate.
+*/
+static int
+box_char(
+	    int row,
+	    int col,
+	    int used,
+	    int width)
+{
+    static const char junction[3][4] =
+    {"lwk", "tnu", "mvj"};
+    int edge = (col % width) == 0;
+    int kind;
+
+    if (row == lines - 2) {
+	kind = 2;
+    } else if (row & 1) {
+	return edge ? 'x' : 0;
+    } else {
+	kind = (row == 0) ? 0 : 1;
+    }
+    if (!edge) {
+	return 'q';
+    }
+    return junction[kind][(col == 0) ? 0 : ((col == used - 1) ? 2 : 1)];
+}
+
+/*
+**	box_run(test_list, mode, width)
+**
+**	Fill the screen with a grid of boxes of the given width until the
+**	test time runs out.  The borders are written with the alternate
+**	character set or with UTF-8, and the insides of the boxes with
+**	ordinary text.  Return the number of cells written.
+*/
+static int
+box_run(
+	   TestList * t,
+	   int mode,
+	   int width)
+{
+    int cells = 0;
+    /* stop short of the margin, to avoid the wrap glitches */
+    int used = (((columns - 2) / width) * width) + 1;
+
+    box_switches = box_rows = 0;
+    pad_test_startup(1);
+    /* the model does not know the alternate character set */
+    model_forget();
+    do {
+	int row, col;
+
+	go_home();
+	for (row = 0; row < lines - 1; row++) {
+	    int in_acs = FALSE;
+
+	    if (mode == BOX_ENACS) {
+		put_mode(ena_acs);
+	    }
+	    for (col = 0; col < used; col++) {
+		int c = box_char(row, col, used, width);
+
+		if (c == 0) {
+		    if (in_acs) {
+			put_mode(exit_alt_charset_mode);
+			in_acs = FALSE;
+		    }
+		    put_this(letter);
+		} else if (mode == BOX_UTF8) {
+		    const char *s;
+
+		    for (s = box_utf8[c]; *s != '\0'; s++) {
+			put_this(UChar(*s));
+		    }
+		} else {
+		    if (!in_acs) {
+			put_mode(enter_alt_charset_mode);
+			in_acs = TRUE;
+			box_switches++;
+		    }
+		    put_this(box_acs[c]);
+		}
+		cells++;
+	    }
+	    if (in_acs) {
+		put_mode(exit_alt_charset_mode);
+	    }
+	    put_crlf();
+	    box_rows++;
+	    SLOW_TERMINAL_EXIT;
+	}
+	NEXT_LETTER;
+    } while (still_testing());
+    pad_test_shutdown(t, 0);
+    return cells;
+}
+
+/*
+**	charset_box(test_list, status, ch)
+**
+**	Time a screen of boxes drawn with (smacs) (rmacs), switching at
+**	different rates, and compare with UTF-8 box drawing characters and
+**	with (enacs) sent before each row.  The cost of a switch is the
+**	time per cell added by the extra switches of the narrow boxes over
+**	the whole-row ones.  It is compared with the cost of (enacs) on the
+**	same rows, those of the (enacs) run's width.
+*/
+static void
+charset_box(
+	       TestList * t,
+	       int *state,
+	       int *ch)
+{
+    int width[BOX_WIDTHS];
+    unsigned long rate[BOX_WIDTHS][BOX_last];
+    int cell_ps[BOX_WIDTHS][BOX_last];	/* picoseconds per cell */
+    int switch_ppm[BOX_WIDTHS];	/* (smacs) per million cells */
+    int switches[BOX_WIDTHS];
+    int row_cells = 0;		/* cells per row at BOX_ENACS_WIDTH */
+    int w, mode, cells, loss;
+    int switch_ns, switch_row_ns, enacs_row_ns;
+    unsigned long elapsed;
+    char name[40];
+
+    if (!enter_alt_charset_mode || !exit_alt_charset_mode) {
+	ptext("(smacs) (rmacs) are not defined.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+    if (skip_pad_test(t, state, ch,
+		      "(smacs) (rmacs) Start line drawing throughput test")) {
+	return;
+    }
+    box_prepare();
+    width[0] = 2;
+    width[1] = 8;
+    width[2] = columns - 2;
+    for (w = 0; w < BOX_WIDTHS; w++) {
+	for (mode = 0; mode < BOX_last; mode++) {
+	    rate[w][mode] = 0;
+	    cell_ps[w][mode] = 0;
+	    if (mode == BOX_ENACS
+		&& (w != BOX_ENACS_WIDTH || !VALID_STRING(ena_acs))) {
+		continue;
+	    }
+	    cells = box_run(t, mode, width[w]);
+	    elapsed = usec_run_time ? usec_run_time : 1;
+	    if (mode == BOX_ACS) {
+		switches[w] = box_rows ? box_switches / box_rows : 0;
+		switch_ppm[w] = sliding_scale(box_switches, 1000000,
+					      (unsigned long) cells);
+		if (w == BOX_ENACS_WIDTH && box_rows) {
+		    row_cells = cells / box_rows;
+		}
+	    }
+	    rate[w][mode] = (unsigned long)
+		sliding_scale(cells, 1000000, elapsed);
+	    cell_ps[w][mode] = sliding_scale((int) elapsed, 1000000,
+					     (unsigned long) cells);
+	}
+    }
+    put_clear();
+    ptextln("                         (smacs) (rmacs)        UTF-8  (smacs)");
+    ptextln("box width                      cells/sec    cells/sec  per row");
+    for (w = 0; w < BOX_WIDTHS; w++) {
+	if (w == BOX_WIDTHS - 1) {
+	    strcpy(name, "whole row");
+	} else {
+	    sprintf(name, "%d", width[w]);
+	}
+	sprintf(temp, "%-20s %19lu %12lu %8d",
+		name, rate[w][BOX_ACS], rate[w][BOX_UTF8], switches[w]);
+	ptextln(temp);
+    }
+    put_crlf();
+    loss = 100 - sliding_scale((int) rate[0][BOX_ACS], 100,
+			       rate[BOX_WIDTHS - 1][BOX_ACS]
+			       ? rate[BOX_WIDTHS - 1][BOX_ACS] : 1);
+    sprintf(temp, "Switching at every other cell costs %d%% of the rate when switching once a row.", loss);
+    ptextln(temp);
+    /*
+     * A switch costs the time per cell added by the extra switches per
+     * cell, from the whole-row boxes to the (enacs) width.
+     */
+    switch_ns = 0;
+    if (cell_ps[BOX_ENACS_WIDTH][BOX_ACS] > cell_ps[BOX_WIDTHS - 1][BOX_ACS]
+	&& switch_ppm[BOX_ENACS_WIDTH] > switch_ppm[BOX_WIDTHS - 1]) {
+	switch_ns = sliding_scale(cell_ps[BOX_ENACS_WIDTH][BOX_ACS]
+				  - cell_ps[BOX_WIDTHS - 1][BOX_ACS], 1000,
+				  (unsigned long) (switch_ppm[BOX_ENACS_WIDTH]
+						   - switch_ppm[BOX_WIDTHS - 1]));
+    }
+    switch_row_ns = sliding_scale(switch_ns * row_cells,
+				  switch_ppm[BOX_ENACS_WIDTH], 1000000);
+    sprintf(temp, "A (smacs) (rmacs) switch costs %d nsec, %d nsec per row of %d-cell boxes.",
+	    switch_ns, switch_row_ns, width[BOX_ENACS_WIDTH]);
+    ptextln(temp);
+    if (rate[BOX_ENACS_WIDTH][BOX_ENACS]) {
+	enacs_row_ns = 0;
+	if (cell_ps[BOX_ENACS_WIDTH][BOX_ENACS] > cell_ps[BOX_ENACS_WIDTH][BOX_ACS]) {
+	    enacs_row_ns = sliding_scale(cell_ps[BOX_ENACS_WIDTH][BOX_ENACS]
+					 - cell_ps[BOX_ENACS_WIDTH][BOX_ACS],
+					 row_cells, 1000);
+	}
+	sprintf(temp, "Sending (enacs) before each row of %d-cell boxes costs %d nsec per row.",
+		width[BOX_ENACS_WIDTH], enacs_row_ns);
+	ptextln(temp);
+	if (enacs_row_ns == 0 && switch_row_ns == 0) {
+	    ptextln("Neither cost is large enough to measure.");
+	} else {
+	    ptextln(enacs_row_ns > switch_row_ns
+		    ? "(enacs) is the bottleneck."
+		    : "Switching with (smacs) (rmacs) is the bottleneck.");
+	}
+    } else {
+	ptextln("(enacs) is not defined, so only the switching is measured.");
+    }
+    put_crlf();
+    pad_done_message(t, state, ch);
+}
+
 /*
 **	charset_can_test()
 **
@@ -813,6 +1242,8 @@ TestList acs_test_list[] =
     {MENU_NEXT, 12, "sgr) (sgr0", "ma", NULL, charset_sgr2, NULL},
     {MENU_NEXT, 3, "sitm) (ritm", NULL, NULL, charset_italics, NULL},
     {MENU_NEXT, 3, NULL, NULL, NULL, charset_crossed, NULL},
+    {0, 0, "smacs) (rmacs", NULL, "d) line drawing throughput", charset_box, NULL},
+    {0, 0, "tsl) (fsl) (dsl", "hs", "u) status line update rate", charset_status_rate, NULL},
     {MENU_LAST, 0, NULL, NULL, NULL, NULL, NULL}
 };
 /* *INDENT-ON* */
@@ -33,6 +33,9 @@ static void color_matrix(TestList *, int *, int *);
 static void color_ncv(TestList *, int *, int *);
 static void color_ccc(TestList *, int *, int *);
 static void color_bce(TestList *, int *, int *);
+static void color_direct(TestList *, int *, int *);
+static void color_palette(TestList *, int *, int *);
+static void color_coalesce(TestList *, int *, int *);
 /* *INDENT-OFF* */
 TestList color_test_list[] = {
     MY_EDIT_MENU
@@ -42,6 +45,9 @@ TestList color_test_list[] = {
     {MENU_NEXT, 16, "ncv",               NULL, NULL,            color_ncv,    NULL},
     {MENU_NEXT, 0,  "bce",               NULL, NULL,            color_bce,    NULL},
     {MENU_NEXT | MENU_CLEAR, 0, "ccc) (initc) (initp", "hls op oc", NULL, color_ccc, NULL},
+    {0, 0, "setaf) (setab", NULL, "d) direct color throughput", color_direct, NULL},
+    {0, 0, "initc) (initp", NULL, "p) palette reprogramming rate", color_palette, NULL},
+    {0, 0, "sgr) (setaf) (setab", NULL, "g) attribute coalescing", color_coalesce, NULL},
     {MENU_LAST, 0,  NULL, NULL, NULL, NULL, NULL}
 };
 /* *INDENT-ON* */
@@ -92,6 +98,9 @@ static int R, G, B;
 static void
 reset_colors(void)
 {
+    if (sgr_coalesce) {
+	sgr_forget();
+    }
     tc_putp(orig_colors);
     tc_putp(TPARM_0(orig_pair));
 }
@@ -138,8 +147,12 @@ new_color(
     }
     if (set_a_foreground) {
 	/* set ANSI color (setaf) (setab) */
-	tc_putp(TPARM_1(set_a_foreground, fg));
-	tc_putp(TPARM_1(set_a_background, bg));
+	if (sgr_coalesce) {
+	    sgr_color(fg, bg);
+	} else {
+	    tc_putp(TPARM_1(set_a_foreground, fg));
+	    tc_putp(TPARM_1(set_a_background, bg));
+	}
     } else if (set_foreground) {
 	/* make sure black is zero */
 	(void) color_trans(COLOR_BLACK);
@@ -853,3 +866,485 @@ color_ccc(
     reset_palette();
     generic_done_message(t, state, ch);
 }
+
+/*****************************************************************************
+ *
+ * Direct color (24-bit RGB) throughput
+ *
+ *****************************************************************************/
+
+#define DIRECT_INDEXED	0	/* indexed colors, for comparison */
+#define DIRECT_RANDOM	1	/* a random color for each cell */
+#define DIRECT_GRADIENT	2	/* colors which change smoothly */
+#define DIRECT_last	3
+
+static const char *direct_name[DIRECT_last] =
+{
+    "indexed",
+    "direct random",
+    "direct gradient"
+};
+
+static const char *rgb_foreground;	/* (setrgbf) */
+static const char *rgb_background;	/* (setrgbb) */
+static unsigned long direct_seed;
+
+/*
+**	direct_random()
+**
+**	Return a pseudo-random 24-bit color.  The sequence is the same for
+**	each run, so that the results can be compared.
+*/
+static int
+direct_random(void)
+{
+    direct_seed = (direct_seed * 1103515245UL + 12345UL) & 0xffffffffUL;
+    return (int) ((direct_seed >> 8) & 0xffffff);
+}
+
+/*
+**	direct_color(fg, bg)
+**
+**	Set the foreground and background to 24-bit colors, using (setrgbf)
+**	and (setrgbb) if they are present, or else the direct color form of
+**	(setaf) and (setab).
+*/
+static void
+direct_color(int fg, int bg)
+{
+    if (rgb_foreground != NULL) {
+	tc_putp(TPARM_3(rgb_foreground,
+			(fg >> 16) & 255, (fg >> 8) & 255, fg & 255));
+	tc_putp(TPARM_3(rgb_background,
+			(bg >> 16) & 255, (bg >> 8) & 255, bg & 255));
+    } else {
+	/* values below 8 would select one of the indexed colors */
+	tc_putp(TPARM_1(set_a_foreground, fg < 8 ? 8 : fg));
+	tc_putp(TPARM_1(set_a_background, bg < 8 ? 8 : bg));
+    }
+}
+
+/*
+**	direct_run(test_list, mode)
+**
+**	Fill the screen a cell at a time, changing the colors for each cell,
+**	until the test time runs out.  Return the number of cells written.
+*/
+static int
+direct_run(
+	      TestList * t,
+	      int mode)
+{
+    int cells = 0;
+    int frame = 0;
+
+    direct_seed = 1;
+    pad_test_startup(1);
+    /* the colors change the DECRQCRA checksum */
+    model_forget();
+    do {
+	int row, col;
+
+	go_home();
+	for (row = 0; row < lines - 1; row++) {
+	    for (col = 0; col < columns; col++) {
+		switch (mode) {
+		case DIRECT_INDEXED:
+		    new_color((row + col) & 7,
+			      (row + col + 1 + (frame % 7)) & 7, FALSE);
+		    break;
+		case DIRECT_RANDOM:
+		    direct_color(direct_random(), direct_random());
+		    break;
+		default:
+		    direct_color((((col * 255) / columns) << 16)
+				 | (((row * 255) / lines) << 8)
+				 | ((frame * 8) & 255),
+				 (((frame * 8) & 255) << 16)
+				 | (((col * 255) / columns) << 8)
+				 | ((row * 255) / lines));
+		    break;
+		}
+		put_this(letter);
+		cells++;
+	    }
+	    reset_colors();
+	    put_crlf();
+	    SLOW_TERMINAL_EXIT;
+	}
+	frame++;
+	NEXT_LETTER;
+    } while (still_testing());
+    pad_test_shutdown(t, 0);
+    reset_colors();
+    return cells;
+}
+
+/*
+**	color_direct(test_list, status, ch)
+**
+**	Compare the throughput of direct (24-bit) color changes with that of
+**	indexed colors.
+*/
+static void
+color_direct(
+		TestList * t,
+		int *state,
+		int *ch)
+{
+    int cells[DIRECT_last];
+    unsigned long usec[DIRECT_last];
+    int bytes[DIRECT_last];
+    int mode, modes;
+
+    if (set_a_foreground == NULL || set_a_background == NULL) {
+	ptext("(setaf) (setab) are not present.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+    rgb_foreground = tigetstr((NCURSES_CONST char *) "setrgbf");
+    rgb_background = tigetstr((NCURSES_CONST char *) "setrgbb");
+    if (!VALID_STRING(rgb_foreground) || !VALID_STRING(rgb_background)) {
+	rgb_foreground = rgb_background = NULL;
+    }
+    modes = DIRECT_last;
+    if (rgb_foreground != NULL) {
+	ptextln("Direct colors will be set with (setrgbf) (setrgbb).");
+    } else if (tigetnum((NCURSES_CONST char *) "colors") >= 0x1000000) {
+	ptextln("Direct colors will be set with (setaf) (setab).");
+    } else {
+	ptextln("Neither (setrgbf) (setrgbb) nor direct color (setaf) (setab) are present.");
+	modes = DIRECT_INDEXED + 1;
+    }
+    if (skip_pad_test(t, state, ch,
+		      "(setaf) (setab) Start color throughput test")) {
+	return;
+    }
+    pairs_used = max_colors >= 8 ? 8 : max_colors;
+    for (mode = 0; mode < modes; mode++) {
+	cells[mode] = direct_run(t, mode);
+	usec[mode] = usec_run_time;
+	bytes[mode] = tx_characters;
+    }
+    put_clear();
+    ptextln("                        cells/sec   bytes/sec  bytes/cell");
+    for (mode = 0; mode < modes; mode++) {
+	unsigned long divisor = usec[mode] ? usec[mode] : 1;
+
+	sprintf(temp, "%-20s %12lu %11lu %11lu",
+		direct_name[mode],
+		(unsigned long) sliding_scale(cells[mode], 1000000, divisor),
+		(unsigned long) sliding_scale(bytes[mode], 1000000, divisor),
+		(unsigned long) (cells[mode] ? bytes[mode] / cells[mode] : 0));
+	ptextln(temp);
+    }
+    put_crlf();
+    generic_done_message(t, state, ch);
+}
+
+/*****************************************************************************
+ *
+ * Palette reprogramming rate
+ *
+ *****************************************************************************/
+
+#define PALETTE_FRAMES	8	/* steps in the color cycle */
+#define PALETTE_ARGS	6	/* parameters after the index, for (initp) */
+
+static int palette_args[PALETTE_FRAMES][MAX_PAIR][PALETTE_ARGS];
+
+/*
+**	palette_ramp(phase)
+**
+**	Return a color component for a phase from 0 to 999, rising from 0
+**	to 1000 and falling back again.
+*/
+static int
+palette_ramp(int phase)
+{
+    phase %= 1000;
+    return (phase < 500) ? (phase * 2) : ((1000 - phase) * 2);
+}
+
+/*
+**	palette_color(phase, args)
+**
+**	Store the parameters for the color at a phase of the cycle, in HLS
+**	or RGB depending on the terminal.
+*/
+static void
+palette_color(int phase, int *args)
+{
+    int r = palette_ramp(phase);
+    int g = palette_ramp(phase + 333);
+    int b = palette_ramp(phase + 667);
+
+    if (hue_lightness_saturation) {
+	rgb_2_hls(r, g, b, &args[0], &args[1], &args[2]);
+    } else {
+	args[0] = r;
+	args[1] = g;
+	args[2] = b;
+    }
+}
+
+/*
+**	palette_prepare(entries, pairs)
+**
+**	Compute the parameters for each entry of each frame of the color
+**	cycle, so that the timing loop only has to send them.  A color pair
+**	gets the complementary color as its background.
+*/
+static void
+palette_prepare(int entries, int pairs)
+{
+    int frame, n;
+
+    for (frame = 0; frame < PALETTE_FRAMES; frame++) {
+	for (n = 0; n < entries; n++) {
+	    int phase = ((n * 1000) / entries) + ((frame * 1000) / PALETTE_FRAMES);
+
+	    palette_color(phase, &palette_args[frame][n][0]);
+	    if (pairs) {
+		palette_color(phase + 500, &palette_args[frame][n][3]);
+	    }
+	}
+    }
+}
+
+/*
+**	color_palette(test_list, status, ch)
+**
+**	Time how fast the terminal accepts (initc) or (initp), cycling the
+**	colors of a row of swatches.
+*/
+static void
+color_palette(
+		 TestList * t,
+		 int *state,
+		 int *ch)
+{
+    const char *cap;
+    int use_pairs = !(set_a_foreground || set_foreground);
+    int entries = use_pairs ? max_pairs : max_colors;
+    int frame = 0, n;
+    unsigned long sent = 0;
+    char tbuf[32];
+
+    cap = use_pairs ? initialize_pair : initialize_color;
+    if (!can_change || cap == NULL) {
+	ptext("(ccc) (initc) (initp) The palette can not be changed.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+    if (entries > MAX_PAIR) {
+	entries = MAX_PAIR;
+    }
+    if (entries > columns / 2) {
+	entries = columns / 2;
+    }
+    if (skip_pad_test(t, state, ch, use_pairs
+		      ? "(initp) Start palette test"
+		      : "(initc) Start palette test")) {
+	return;
+    }
+    palette_prepare(entries, use_pairs);
+
+    /* show a swatch for each entry, which changes as the palette does */
+    put_clear();
+    for (n = 0; n < entries; n++) {
+	if (use_pairs) {
+	    tc_putp(TPARM_1(set_color_pair, n));
+	} else if (set_a_background) {
+	    tc_putp(TPARM_1(set_a_background, n));
+	} else {
+	    tc_putp(TPARM_1(set_background, n));
+	}
+	put_str("  ");
+    }
+    reset_colors();
+    put_crlf();
+    model_forget();
+
+    pad_test_startup(0);
+    do {
+	for (n = 0; n < entries; n++) {
+	    const int *v = palette_args[frame][n];
+
+	    if (use_pairs) {
+		tt_putvalue(cap, TPARM_7(cap, n, v[0], v[1], v[2],
+					 v[3], v[4], v[5]), 1);
+	    } else {
+		tt_putvalue(cap, TPARM_4(cap, n, v[0], v[1], v[2]), 1);
+	    }
+	    sent++;
+	    SLOW_TERMINAL_EXIT;
+	}
+	frame = (frame + 1) % PALETTE_FRAMES;
+    } while (still_testing());
+    pad_test_shutdown(t, 0);
+    reset_palette();
+
+    sprintf(tbuf, "%011lu", usec_run_time);
+    sprintf(temp, "%lu palette entries in %lu.%s seconds, %lu entries per second.",
+	    sent, usec_run_time / 1000000UL, &tbuf[5],
+	    (unsigned long) sliding_scale((int) sent, 1000000,
+					  usec_run_time ? usec_run_time : 1));
+    ptextln(temp);
+    if ((n = get_string_cap_byvalue(cap)) >= 0) {
+	show_cap_results(n);
+    }
+    pad_done_message(t, state, ch);
+}
+
+/*****************************************************************************
+ *
+ * Attribute and color coalescing
+ *
+ *****************************************************************************/
+
+#define COALESCE_WORD	6	/* cells which share the same rendition */
+
+/* the sgr parameters: bold, underline, reverse */
+static const int coalesce_attrs[] =
+{
+    0, 1 << 6, 0, 1 << 2, 0, 1 << 3, (1 << 6) | (1 << 2)
+};
+
+/*
+**	coalesce_run(test_list, flag, colors)
+**
+**	Fill the screen with words of text in a mixture of attributes and
+**	colors.  Like a simple renderer, set the attributes and colors for
+**	every cell, with the tracker on or off as flag says.  Return the
+**	number of cells written.
+*/
+static int
+coalesce_run(
+		TestList * t,
+		int flag,
+		int colors)
+{
+    int cells = 0;
+    int frame = 0;
+
+    sgr_start(flag);
+    pad_test_startup(1);
+    /* the attributes change the DECRQCRA checksum */
+    model_forget();
+    do {
+	int row, col;
+
+	go_home();
+	for (row = 0; row < lines - 1; row++) {
+	    for (col = 0; col < columns; col++) {
+		int word = (col / COALESCE_WORD) + row + frame;
+
+		if (set_attributes) {
+		    set_attr(coalesce_attrs[(word / 3)
+					    % (int) (sizeof(coalesce_attrs)
+						     / sizeof(coalesce_attrs[0]))]);
+		}
+		if (colors > 1) {
+		    int fg = word % colors;
+
+		    new_color(fg,
+			      (fg + 1 + (word / 4) % (colors - 1)) % colors,
+			      FALSE);
+		}
+		put_this(letter);
+		cells++;
+	    }
+	    if (set_attributes) {
+		set_attr(0);
+	    }
+	    reset_colors();
+	    put_crlf();
+	    SLOW_TERMINAL_EXIT;
+	}
+	frame++;
+	NEXT_LETTER;
+    } while (still_testing());
+    pad_test_shutdown(t, 0);
+    sgr_start(FALSE);
+    return cells;
+}
+
+/*
+**	color_coalesce(test_list, status, ch)
+**
+**	Compare the characters and time needed to draw the same screens
+**	with every attribute and color change sent, and with the changes
+**	passed through the tracker in sgr.c.
+*/
+static void
+color_coalesce(
+		  TestList * t,
+		  int *state,
+		  int *ch)
+{
+    static const char *names[2] =
+    {
+	"every change sent",
+	"coalesced"
+    };
+    int colors = max_colors >= 8 ? 8 : max_colors;
+    int cells[2];
+    int bytes[2];
+    int size[2];
+    int speed[2];
+    unsigned long usec[2];
+    int n, changes, dropped, merged;
+
+    if (!set_a_foreground || !set_a_background) {
+	colors = 0;
+    }
+    if (magic_cookie_glitch > 0 || (colors <= 1 && !set_attributes)) {
+	ptext("(sgr) (setaf) (setab) There are no changes which could be coalesced.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+    if (skip_pad_test(t, state, ch,
+		      "(sgr) (setaf) (setab) Start attribute coalescing test")) {
+	return;
+    }
+    for (n = 0; n < 2; n++) {
+	cells[n] = coalesce_run(t, n, colors);
+	usec[n] = usec_run_time;
+	bytes[n] = tx_characters;
+	/* characters per 100 cells, and nanoseconds per cell */
+	size[n] = sliding_scale(bytes[n], 100,
+				(unsigned long) (cells[n] ? cells[n] : 1));
+	speed[n] = sliding_scale((int) usec[n], 1000,
+				 (unsigned long) (cells[n] ? cells[n] : 1));
+    }
+    changes = sgr_changes;
+    dropped = sgr_dropped;
+    merged = sgr_merged;
+    set_attr(0);
+    reset_colors();
+    put_clear();
+    ptextln("                        cells/sec   bytes/sec  bytes/cell");
+    for (n = 0; n < 2; n++) {
+	unsigned long divisor = usec[n] ? usec[n] : 1;
+
+	sprintf(temp, "%-20s %12lu %11lu %8d.%02d",
+		names[n],
+		(unsigned long) sliding_scale(cells[n], 1000000, divisor),
+		(unsigned long) sliding_scale(bytes[n], 1000000, divisor),
+		size[n] / 100, size[n] % 100);
+	ptextln(temp);
+    }
+    put_crlf();
+    sprintf(temp, "Coalescing saved %d%% of the characters and %d%% of the time per cell.",
+	    100 - sliding_scale(size[1], 100,
+				(unsigned long) (size[0] ? size[0] : 1)),
+	    100 - sliding_scale(speed[1], 100,
+				(unsigned long) (speed[0] ? speed[0] : 1)));
+    ptextln(temp);
+    sprintf(temp, "%d of %d changes were redundant, and %d were combined with another.",
+	    dropped, changes, merged);
+    ptextln(temp);
+    put_crlf();
+    generic_done_message(t, state, ch);
+}
@@ -46,6 +46,27 @@ SIG_ATOMIC_T no_alarm_event;	/* TRUE if the alarm has not gone off yet */
 unsigned long usec_run_time;	/* length of last test in microseconds */
 static MY_TIMER stop_watch[MAX_TIMERS];		/* Hold the start timers */
 
+/* instrumentation counters */
+unsigned long counter_value[CNT_last];	/* totals for this session */
+static unsigned long counter_start[CNT_last];	/* totals when test began */
+static unsigned long counter_test[CNT_last];	/* counts for the last test */
+
+static const char *const counter_names[CNT_last] =
+{
+    "characters written",
+    "write calls",
+    "output flushes",
+    "microseconds in writes",
+    "characters read",
+    "read calls",
+    "sync probes",
+    "sync failures",
+    "microseconds in tputs",
+    "microseconds in tparm",
+    "pad milliseconds requested",
+    "pad milliseconds observed"
+};
+
 char txt_longer_augment[80];	/* >) use bigger augment */
 char txt_shorter_augment[80];	/* <) use smaller augment */
 
@@ -67,19 +88,19 @@ int tx_delay[TT_MAX];		/* Number of milliseconds delay */
 int txp;			/* number of entries used */
 int tx_characters;		/* printing characters sent by test */
 unsigned long tx_cps;		/* characters per second */
+int tx_queue_peak;		/* most characters in the output queue */
+unsigned long tx_drain_cps;	/* characters per second leaving the queue */
 static TestList *tx_source;	/* The test that generated this data */
 
-#define RESULT_BLOCK		1024
-static int blocks;		/* number of result blocks available */
-static TestResults *results;	/* pointer to next available */
 static TestResults **pads;	/* save pad results here */
 
 static void
 alloc_arrays(void)
 {
     if (pads == NULL) {
-	pads = (TestResults **) calloc((size_t) MAX_STRINGS,
-				       sizeof(TestResults *));
+	pads = (TestResults **) arena_alloc(&session_arena,
+					    sizeof(TestResults *)
+					    * (size_t) MAX_STRINGS);
     }
 }
 
@@ -117,6 +138,41 @@ event_time(int n)
 #endif
 }
 
+/*
+**	show_counters(test_list, status, ch)
+**
+**	Display the instrumentation counters for the last test and the
+**	totals for this session.
+*/
+void
+show_counters(
+		 TestList * t,
+		 int *state,
+		 int *ch)
+{
+    int i;
+
+    put_crlf();
+    sprintf(temp, "%-28s %12s %12s", "Counter", "Last test", "Total");
+    ptextln(temp);
+    for (i = 0; i < CNT_last; i++) {
+	sprintf(temp, "%-28s %12lu %12lu",
+		counter_names[i], counter_test[i], counter_value[i]);
+	ptextln(temp);
+    }
+    if (counter_test[CNT_TPUTS_USEC] + counter_test[CNT_TPARM_USEC]) {
+	unsigned long busy = (counter_test[CNT_TPUTS_USEC]
+			      + counter_test[CNT_TPARM_USEC]);
+	unsigned long wait = counter_test[CNT_WRITE_USEC];
+
+	/* time spent blocked in writes is the terminal's, the rest is ours */
+	sprintf(temp, "Last test was %s-bound",
+		(wait * 2 > busy) ? "terminal" : "tack");
+	ptextln(temp);
+    }
+    generic_done_message(t, state, ch);
+}
+
 /*****************************************************************************
  *
  * Execution control for string capability tests
@@ -131,17 +187,62 @@ event_time(int n)
 static TestResults *
 get_next_block(void)
 {
-    if (blocks <= 0) {
-	results = (TestResults *)
-	    malloc(sizeof(TestResults) * RESULT_BLOCK);
-	if (!results) {
-	    ptextln("Malloc failed");
-	    return (TestResults *) 0;
+    return (TestResults *) arena_alloc(&results_arena, sizeof(TestResults));
+}
+
+/*
+**	pad_results_reset()
+**
+**	Discard the saved pad test results at the start of a test run.
+*/
+void
+pad_results_reset(void)
+{
+    alloc_arrays();
+    memset(pads, 0, sizeof(TestResults *) * (size_t) MAX_STRINGS);
+    arena_reset(&results_arena);
+}
+
+/*
+**	pad_cap_swapped(index, old-value, new-value)
+**
+**	A string cap has been given a new value.  Move the timing data of
+**	the running test and of the last test from the old value to the new
+**	one, recomputing the delays, so that the caps are still found by
+**	get_string_cap_byvalue() and the new padding is counted from the
+**	next use.  If the cap was deleted, the timing data and the saved
+**	pad results for it are discarded.
+*/
+void
+pad_cap_swapped(
+		   int x,
+		   const char *old,
+		   const char *value)
+{
+    int i;
+
+    if (old == NULL) {
+	return;
+    }
+    if (value == NULL) {
+	alloc_arrays();
+	pads[x] = NULL;
+    }
+    for (i = 0; i < ttp; i++) {
+	if (tt_cap[i] == old) {
+	    tt_cap[i] = value;
+	    tt_delay[i] = value ? msec_cost(value, tt_affected[i]) : 0;
+	}
+    }
+    for (i = 0; i < txp; i++) {
+	if (tx_cap[i] == old) {
+	    tx_cap[i] = value;
+	    tx_delay[i] = value ? msec_cost(value, tx_affected[i]) : 0;
+	    if (value == NULL) {
+		tx_index[i] = -1;
+	    }
 	}
-	blocks = RESULT_BLOCK;
     }
-    blocks--;
-    return results++;
 }
 
 /*
@@ -257,11 +358,73 @@ page_loop(void)
     }
 }
 
+/*
+**	cached_pad_test(test-list-entry, restore)
+**
+**	Look in the result cache for each cap of the test which is defined.
+**	If all of them are found, show the cached delays and return TRUE.
+**	If restore is set, also save the cached results as if the test had
+**	been run.
+*/
+static int
+cached_pad_test(
+		   TestList * test,
+		   int restore)
+{
+    int x[32];
+    int i, pass, defined = 0, found = 0;
+
+    if (test->caps_done == NULL) {
+	return FALSE;
+    }
+    alloc_arrays();
+    cap_index(test->caps_done, x);
+    for (pass = 0; pass < 2; pass++) {
+	for (i = 0; x[i] >= 0; i++) {
+	    const char *long_name;
+	    const char *value = get_string_cap_byname(strnames[x[i]], &long_name);
+	    int reps, delay;
+
+	    if (!VALID_STRING(value)) {
+		continue;
+	    }
+	    if (pass == 0) {
+		defined++;
+		if (cache_lookup(strnames[x[i]], value, &reps, &delay)) {
+		    found++;
+		}
+	    } else if (cache_lookup(strnames[x[i]], value, &reps, &delay)) {
+		sprintf(temp, "(%s) cached $<%d> ", strnames[x[i]], delay / 1000);
+		ptext(temp);
+		if (batch_mode) {
+		    fprintf(stderr, "%-16s cached  $<%d>\n", strnames[x[i]], delay / 1000);
+		}
+		if (restore) {
+		    TestResults *r;
+
+		    r = get_next_block();
+		    r->next = pads[x[i]];
+		    pads[x[i]] = r;
+		    r->test = test;
+		    r->reps = reps;
+		    r->delay = delay;
+		}
+	    }
+	}
+	if (defined == 0 || found < defined) {
+	    return FALSE;
+	}
+    }
+    put_crlf();
+    return TRUE;
+}
+
 /*
 **	skip_pad_test(test-list-entry, state, ch, text)
 **
 **	Print the start test line.  Handle start up commands.
 **	Return TRUE if a return is requested.
+**	In batch mode, a test whose results are all cached is skipped.
 */
 int
 skip_pad_test(
@@ -272,6 +435,10 @@ skip_pad_test(
 {
     char rep_text[16];
 
+    if (cached_pad_test(test, batch_mode) && batch_mode) {
+	*ch = 'n';
+	return TRUE;
+    }
     while (1) {
 	if (text) {
 	    ptext(text);
@@ -394,11 +561,13 @@ pad_test_startup(
     repeats = augment;
     raw_characters_sent = 0;
     test_complete = ttp = char_count = tt_delay_used = 0;
+    tx_queue_peak = 0;
     letter = letters[letter_number = 0];
     if (pad_test_duration <= 0) {
 	pad_test_duration = 1;
     }
     tt_delay_max = pad_test_duration * 1000;
+    memcpy(counter_start, counter_value, sizeof(counter_start));
     set_alarm_clock(pad_test_duration);
     event_start(TIME_TEST);
 }
@@ -411,11 +580,45 @@ pad_test_startup(
 int
 still_testing(void)
 {
-    fflush(stdout);
+    int queued;
+
+    flush_output();
+    if ((queued = tty_queued()) > tx_queue_peak) {
+	tx_queue_peak = queued;
+    }
     test_complete++;
     return EXIT_CONDITION;
 }
 
+/*
+**	batch_report(test_list, delay)
+**
+**	In batch mode, write a line for each timing test to the standard error.
+*/
+static void
+batch_report(
+		TestList * t,
+		int delay)
+{
+    char tbuf[32];
+
+    sprintf(tbuf, "%011lu", usec_run_time);
+    fprintf(stderr, "%-16s %5lu.%s sec %8d chars %8lu cps",
+	    t->caps_done ? t->caps_done : "?",
+	    usec_run_time / 1000000UL, &tbuf[5],
+	    tx_characters, tx_cps);
+    if (delay >= 0) {
+	fprintf(stderr, "  $<%d>", delay / 1000);
+    }
+    if (tx_queue_peak > 0) {
+	fprintf(stderr, "  queue %d", tx_queue_peak);
+	if (tx_drain_cps) {
+	    fprintf(stderr, " drain %lu cps", tx_drain_cps);
+	}
+    }
+    fprintf(stderr, "\n");
+}
+
 /*
 **	pad_test_shutdown()
 **
@@ -434,14 +637,36 @@ pad_test_shutdown(
     int bogus;			/* Time is inaccurate */
     TestResults *r;		/* Results of current test */
     int ss_index[TT_MAX];	/* String index */
+    int queued;			/* characters in the output queue */
+    long drain_time;		/* microseconds to empty the queue */
 
     alloc_arrays();
+    /*
+       Characters still in the output queue have not reached the terminal.
+       Wait for them before stopping the clock, and use the time that takes
+       to see how fast the terminal really drains the queue.
+     */
+    queued = tty_queued();
+    event_start(TIME_DRAIN);
+    tty_drain();
+    drain_time = event_time(TIME_DRAIN);
+    if (queued > tx_queue_peak) {
+	tx_queue_peak = queued;
+    }
+    tx_drain_cps = 0;
+    if (queued > 0 && drain_time > 0) {
+	tx_drain_cps = (unsigned long) sliding_scale(queued, 1000000,
+						     (unsigned long) drain_time);
+    }
     if (tty_can_sync == SYNC_TESTED) {
 	bogus = tty_sync_error();
     } else {
 	bogus = 1;
     }
     usec_run_time = (unsigned long) event_time(TIME_TEST);
+    for (i = 0; i < CNT_last; i++) {
+	counter_test[i] = counter_value[i] - counter_start[i];
+    }
     tx_source = t;
     tx_characters = raw_characters_sent;
     tx_cps = (unsigned long) sliding_scale(tx_characters, 1000000, usec_run_time);
@@ -461,11 +686,14 @@ pad_test_shutdown(
 	}
     }
 
+    (void) model_verify(t);
     if (crlf) {
 	put_crlf();
     }
     if (counts == 0 || tty_cps == 0 || bogus) {
 	/* nothing to do */
+	if (batch_mode)
+	    batch_report(t, -1);
 	return;
     }
     /* calculate the suggested pad times */
@@ -477,16 +705,20 @@ pad_test_shutdown(
 	/* probably should bump tx_characters */
 	delta = 0;
     }
+    COUNT_ADD(CNT_PAD_OBSERVED, delta / 1000);
+    counter_test[CNT_PAD_OBSERVED] += (unsigned long) (delta / 1000);
     cpo = (int) (delta / counts);
+    if (batch_mode)
+	batch_report(t, cpo);
     for (i = 0; i < ss; i++) {
-	if (!(r = get_next_block())) {
-	    return;
-	}
+	r = get_next_block();
 	r->next = pads[tx_index[ss_index[i]]];
 	pads[tx_index[ss_index[i]]] = r;
 	r->test = t;
 	r->reps = tx_affected[ss_index[i]];
 	r->delay = cpo;
+	cache_store(strnames[tx_index[ss_index[i]]], tx_cap[ss_index[i]],
+		    r->reps, r->delay);
     }
 }
 
@@ -495,7 +727,7 @@ pad_test_shutdown(
 **
 **	Display the previous results
 */
-static void
+void
 show_cap_results(
 		    int x)
 {
@@ -557,9 +789,19 @@ dump_test_stats(
 	    "Test time: %lu.%s, characters per second %lu, characters %d",
 	    usec_run_time / 1000000UL, &tbuf[5], tx_cps, tx_characters);
     ptextln(temp);
+    if (tx_queue_peak > 0) {
+	sprintf(temp,
+		"Output queue: at most %d characters, drained at %lu characters per second",
+		tx_queue_peak, tx_drain_cps);
+	ptextln(temp);
+    }
 
     for (i = 0; i < txp; i++) {
 	int j;
+	if (tx_cap[i] == NULL) {
+	    /* the cap was deleted */
+	    continue;
+	}
 	if ((j = get_string_cap_byvalue(tx_cap[i])) >= 0) {
 	    sprintf(tbuf, "(%s)", strnames[j]);
 	} else {
@@ -570,6 +812,16 @@ dump_test_stats(
 		tbuf, expand(tx_cap[i]));
 	putln(temp);
     }
+    sprintf(temp,
+	    "Wrote %lu characters in %lu calls, read %lu characters in %lu calls",
+	    counter_test[CNT_WRITE_BYTES], counter_test[CNT_WRITE_CALLS],
+	    counter_test[CNT_READ_BYTES], counter_test[CNT_READ_CALLS]);
+    ptextln(temp);
+    sprintf(temp,
+	    "tputs %lu usec, tparm %lu usec, pad requested %lu msec, observed %lu msec",
+	    counter_test[CNT_TPUTS_USEC], counter_test[CNT_TPARM_USEC],
+	    counter_test[CNT_PAD_REQUESTED], counter_test[CNT_PAD_OBSERVED]);
+    ptextln(temp);
     generic_done_message(t, state, ch);
 }
 
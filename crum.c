@@ -64,48 +64,39 @@ move_to(
 	   int ct,
 	   int sel)
 {
-    char *s;
-
     if (sel & 16) {		/* use (cup) */
-	s = TPARM_2(cursor_address, rt, ct);
-	tputs(s, lines, tc_putch);
+	tt_putparm(cursor_address, lines, rt, ct);
 	return;
     }
     if (sel & 8) {		/* use (hpa) (vpa) */
 	if (column_address) {
-	    s = TPARM_1(column_address, ct);
-	    tputs(s, 1, tc_putch);
+	    tt_putparm(column_address, 1, ct, 0);
 	    cf = ct;
 	}
 	if (row_address) {
-	    s = TPARM_1(row_address, rt);
-	    tputs(s, 1, tc_putch);
+	    tt_putparm(row_address, 1, rt, 0);
 	    rf = rt;
 	}
     }
     if (sel & 4) {		/* parameterized relative cursor movement */
 	if (parm_right_cursor)
 	    if (cf < ct) {
-		s = TPARM_1(parm_right_cursor, ct - cf);
-		tputs(s, ct - cf, tc_putch);
+		tt_putparm(parm_right_cursor, ct - cf, ct - cf, 0);
 		cf = ct;
 	    }
 	if (parm_left_cursor)
 	    if (cf > ct) {
-		s = TPARM_1(parm_left_cursor, cf - ct);
-		tputs(s, cf - ct, tc_putch);
+		tt_putparm(parm_left_cursor, cf - ct, cf - ct, 0);
 		cf = ct;
 	    }
 	if (parm_down_cursor)
 	    if (rf < rt) {
-		s = TPARM_1(parm_down_cursor, rt - rf);
-		tputs(s, rt - rf, tc_putch);
+		tt_putparm(parm_down_cursor, rt - rf, rt - rf, 0);
 		rf = rt;
 	    }
 	if (parm_up_cursor)
 	    if (rf > rt) {
-		s = TPARM_1(parm_up_cursor, rf - rt);
-		tputs(s, rf - rt, tc_putch);
+		tt_putparm(parm_up_cursor, rf - rt, rf - rt, 0);
 		rf = rt;
 	    }
     }
@@ -256,6 +247,7 @@ crum_clear(
 	put_clear();
 	ptextln("This line should start in the home position.");
 	ptext("The rest of the screen should be clear.  ");
+	(void) model_verify(t);
     } else {
 	ptextln("(clear) Clear screen is not defined.  ");
     }
@@ -285,6 +277,7 @@ crum_home(
 	go_home();
 	ptextln("This line starts in the home position.");
 	put_crlf();
+	(void) model_verify(t);
     } else {
 	ptextln("(home) Home cursor is not defined.  ");
     }
@@ -312,6 +305,7 @@ crum_ll(
 	ptext("This line should be on the bottom");
 	go_home();
 	put_crlf();
+	(void) model_verify(t);
     } else if (cursor_address) {
 	return;
     } else {
@@ -383,6 +377,7 @@ crum_move(
 	crum_text[n][strlen(buf) - 3] = '\0';
 
 	display_it(1 << n, buf);
+	(void) model_verify(t);
     }
     *ch = wait_here();
     if (*ch != 'r') {
@@ -46,6 +46,9 @@ typedef struct {
 #define SHOW_EDIT	2
 #define SHOW_DELETE	3
 
+#define DIFF_SUFFIX	".diff"	/* suffix for the file written by save_changes */
+#define COMPILED_DIR	"terminfo"	/* directory written by save_compiled */
+
 static char change_pad_text[MAX_CHANGES][80];
 static TestList change_pad_list[MAX_CHANGES] =
 {
@@ -58,28 +61,51 @@ static TERMTYPE original_term;	/* terminal type description */
 static char *flag_boolean;	/* flags for booleans */
 static char *flag_numbers;	/* flags for numerics */
 static char *flag_strings;	/* flags for strings */
-static int *label_strings;
 static int xon_index;		/* Subscript for (xon) */
 static int xon_shadow;
 
 #if TACK_CAN_EDIT
 static int start_display;	/* the display has just started */
 static int display_lines;	/* number of lines displayed */
+
+typedef struct {
+    NAME_TYPE ct_type;
+    int ct_index;
+} CHANGE_TABLE;
+
+static CHANGE_TABLE *change_table;	/* caps which may differ from original */
+static int change_count;	/* number of entries in change_table */
+static char *change_flags;	/* by cap ordinal, TRUE if in change_table */
+
+static int type_ordinal(NAME_TYPE, int);
 #endif
 
 static void
 alloc_arrays(void)
 {
     if (flag_boolean == NULL) {
-	flag_boolean = (char *) calloc((size_t) MAX_BOOLEAN, sizeof(char));
+	flag_boolean = (char *) arena_alloc(&session_arena,
+					    (size_t) MAX_BOOLEAN);
     }
     if (flag_numbers == NULL) {
-	flag_numbers = (char *) calloc((size_t) MAX_NUMBERS, sizeof(char));
+	flag_numbers = (char *) arena_alloc(&session_arena,
+					    (size_t) MAX_NUMBERS);
     }
     if (flag_strings == NULL) {
-	label_strings = (int *) calloc((size_t) MAX_STRINGS, sizeof(int));
-	flag_strings = (char *) calloc((size_t) MAX_STRINGS, sizeof(char));
+	flag_strings = (char *) arena_alloc(&session_arena,
+					    (size_t) MAX_STRINGS);
+    }
+#if TACK_CAN_EDIT
+    if (change_table == NULL) {
+	change_table = (CHANGE_TABLE *) arena_alloc(&session_arena,
+						    sizeof(CHANGE_TABLE)
+						    * (size_t) MAX_CAPS);
+    }
+    if (change_flags == NULL) {
+	change_flags = (char *) arena_alloc(&session_arena,
+					    (size_t) MAX_CAPS);
     }
+#endif
 }
 
 static int
@@ -308,35 +334,106 @@ get_string_cap_byvalue(
     return -1;
 }
 
+#if TACK_CAN_EDIT
 /*
-**	user_modified()
+**	mark_changed(type, index)
 **
-**	Return TRUE if the user has modified the terminfo
+**	Remember that the cap may have been modified.  Only the caps in
+**	change_table need to be compared with the original terminfo.
 */
-#if TACK_CAN_EDIT
-int
-user_modified(void)
+static void
+mark_changed(NAME_TYPE type, int index)
 {
-    int i;
+    int x = type_ordinal(type, index);
 
-    for (i = 0; i < MAX_BOOLEAN; i++) {
-	int v = (i == xon_index) ? xon_shadow : get_newer_boolean(i);
-	if (get_saved_boolean(i) != v) {
-	    return TRUE;
-	}
+    alloc_arrays();
+    if (!change_flags[x]) {
+	change_flags[x] = TRUE;
+	change_table[change_count].ct_type = type;
+	change_table[change_count].ct_index = index;
+	change_count++;
     }
-    for (i = 0; i < MAX_NUMBERS; i++) {
-	if (get_saved_number(i) != get_newer_number(i)) {
-	    return TRUE;
-	}
+}
+
+/*
+**	patch_string(index, value)
+**
+**	Replace the value of a string cap, even while a test is running.
+**	The new value is copied to the session arena, and the old value is
+**	never freed, so a pointer to it held by a test or by the tparm cache
+**	of the curses library can never match the new value by accident.
+**	The timing data for the running test and for the last test which
+**	refer to the old value are moved to the new one, and their delays
+**	recomputed, so the next iteration of a test sees the new padding.
+**	A null value deletes the cap, and discards its timing data.
+*/
+void
+patch_string(
+		int x,
+		const char *value)
+{
+    const char *old = get_newer_string(x);
+    char *copy = NULL;
+
+    if (value != NULL) {
+	copy = arena_strdup(&session_arena, value);
     }
-    for (i = 0; i < (int) MAX_STRINGS; i++) {
-	const char *a, *b;
+    mark_changed(STRING, x);
+    set_newer_string(x, copy);
+    pad_cap_swapped(x, old, copy);
+}
+
+/*
+**	cap_changed(change)
+**
+**	Return TRUE if the cap differs from the original terminfo.  A cap
+**	which was changed back to its original value is not reported.
+*/
+static int
+cap_changed(const CHANGE_TABLE * p)
+{
+    int i = p->ct_index;
+    const char *a, *b;
+
+    switch (p->ct_type) {
+    case BOOLEAN:
+	return (get_saved_boolean(i)
+		!= ((i == xon_index) ? xon_shadow : get_newer_boolean(i)));
+    case NUMBER:
+	return get_saved_number(i) != get_newer_number(i);
+    case STRING:
+    default:
 	if ((a = get_saved_string(i)) == NULL)
 	    a = "";
 	if ((b = get_newer_string(i)) == NULL)
 	    b = "";
-	if (strcmp(a, b)) {
+	return strcmp(a, b) != 0;
+    }
+}
+
+static int
+compare_change(const void *a, const void *b)
+{
+    const CHANGE_TABLE *p = (const CHANGE_TABLE *) a;
+    const CHANGE_TABLE *q = (const CHANGE_TABLE *) b;
+
+    if (p->ct_type != q->ct_type)
+	return (int) p->ct_type - (int) q->ct_type;
+    return p->ct_index - q->ct_index;
+}
+
+/*
+**	user_modified()
+**
+**	Return TRUE if the user has modified the terminfo
+*/
+int
+user_modified(void)
+{
+    int i;
+
+    for (i = 0; i < change_count; i++) {
+	if (cap_changed(&change_table[i])) {
 	    return TRUE;
 	}
     }
@@ -465,6 +562,180 @@ cap_index(
     *inx = -1;
 }
 
+/*
+**	type_ordinal(type, index)
+**
+**	Return the cap_ordinal() value for a cap given its type and index.
+*/
+static int
+type_ordinal(NAME_TYPE type, int index)
+{
+    switch (type) {
+    case BOOLEAN:
+	return index;
+    case NUMBER:
+	return MAX_BOOLEAN + index;
+    case STRING:
+    default:
+	return MAX_BOOLEAN + MAX_NUMBERS + index;
+    }
+}
+
+/*
+**	cap_ordinal(name)
+**
+**	Return a number for the cap which is unique across the booleans,
+**	numbers and strings (less than MAX_CAPS), or -1 if it is not a cap.
+*/
+int
+cap_ordinal(const char *name)
+{
+    NAME_TABLE const *nt;
+
+    if ((nt = find_capability(name)) != NULL) {
+	return type_ordinal(nt->nt_type, nt->nt_index);
+    }
+    return -1;
+}
+
+/*
+**	ordinal_name(ordinal)
+**
+**	Return the name of the cap with the given cap_ordinal() value.
+*/
+const char *
+ordinal_name(int n)
+{
+    if (n < MAX_BOOLEAN) {
+	return boolnames[n];
+    } else if ((n -= MAX_BOOLEAN) < MAX_NUMBERS) {
+	return numnames[n];
+    }
+    return STR_NAME(n - MAX_NUMBERS);
+}
+
+/*
+**	compare_terminfo(name, ordinal-list)
+**
+**	Load the terminal description for name and list the cap_ordinal()
+**	values of the caps which differ from the terminal being tested.  The
+**	list must have room for MAX_CAPS entries and the terminating -1.
+**	Return the number of caps which differ, or -1 if name is not found.
+*/
+int
+compare_terminfo(
+		    const char *name,
+		    int *inx)
+{
+    TERMINAL *current = cur_term;
+    TERMINAL *other;
+    int total = MAX_CAPS;
+    int count = 0;
+    int status;
+    int n;
+    const char **names;
+    int *numbers;
+    char **strings;
+
+    names = (const char **) calloc((size_t) total, sizeof(const char *));
+    numbers = (int *) calloc((size_t) total, sizeof(int));
+    strings = (char **) calloc((size_t) total, sizeof(char *));
+    if (names == NULL || numbers == NULL || strings == NULL) {
+	count = -1;
+    } else {
+	for (n = 0; n < total; n++) {
+	    names[n] = ordinal_name(n);
+	}
+	if (setupterm((NCURSES_CONST char *) name, 1, &status) != OK) {
+	    set_curterm(current);
+	    count = -1;
+	} else {
+	    other = cur_term;
+	    for (n = 0; n < total; n++) {
+		NCURSES_CONST char *cap = (NCURSES_CONST char *) names[n];
+		if (n < MAX_BOOLEAN) {
+		    numbers[n] = tigetflag(cap);
+		} else if (n < MAX_BOOLEAN + MAX_NUMBERS) {
+		    numbers[n] = tigetnum(cap);
+		} else {
+		    strings[n] = tigetstr(cap);
+		}
+	    }
+	    set_curterm(current);
+	    for (n = 0; n < total; n++) {
+		NCURSES_CONST char *cap = (NCURSES_CONST char *) names[n];
+		int differs;
+		if (n < MAX_BOOLEAN) {
+		    differs = (numbers[n] > 0) != (tigetflag(cap) > 0);
+		} else if (n < MAX_BOOLEAN + MAX_NUMBERS) {
+		    differs = (numbers[n] >= 0 || tigetnum(cap) >= 0)
+			&& numbers[n] != tigetnum(cap);
+		} else {
+		    const char *a = tigetstr(cap);
+		    const char *b = strings[n];
+		    if (!VALID_STRING(a))
+			a = "";
+		    if (!VALID_STRING(b))
+			b = "";
+		    differs = strcmp(a, b) != 0;
+		}
+		if (differs) {
+		    inx[count++] = n;
+		}
+	    }
+	    del_curterm(other);
+	}
+    }
+    if (count >= 0) {
+	inx[count] = -1;
+    }
+    FreeIfNeeded(names);
+    FreeIfNeeded(numbers);
+    FreeIfNeeded(strings);
+    return count;
+}
+
+/*
+**	cap_ordinals(name-list, ordinal-list, max)
+**
+**	Scan the name list and return a list of cap_ordinal() values,
+**	at most max-1 of them.  Names which are not caps are skipped.
+**	<space> ( and ) may be used as separators.
+**	This list is terminated with -1.
+*/
+void
+cap_ordinals(
+		const char *s,
+		int *inx,
+		int max)
+{
+    if (s) {
+	int j;
+	char name[NAME_SIZE];
+
+	for (j = 0; max > 1; s++) {
+	    int ch = name[j] = *s;
+	    if (ch == ' ' || ch == ')' || ch == '(' || ch == 0) {
+		if (j) {
+		    int n;
+		    name[j] = '\0';
+		    if ((n = cap_ordinal(name)) >= 0) {
+			*inx++ = n;
+			--max;
+		    }
+		}
+		if (ch == 0) {
+		    break;
+		}
+		j = 0;
+	    } else if (j < NAME_SIZE - 1) {
+		j++;
+	    }
+	}
+    }
+    *inx = -1;
+}
+
 /*
 **	cap_match(name-list, cap)
 **
@@ -650,7 +921,7 @@ copy_termtype(TERMTYPE *target, TERMTYPE *source)
 }
 #endif /* TACK_CAN_EDIT */
 
-#if NO_LEAKS
+#if NO_LEAKS && TACK_CAN_EDIT
 static void
 free_termtype(TERMTYPE *tp)
 {
@@ -677,9 +948,15 @@ edit_init(void)
 {
     int i, j, lc;
     char *lab;
+    int *label_strings;
     NAME_TABLE const *nt;
 
     alloc_arrays();
+    label_strings = (int *) malloc(sizeof(int) * (size_t) MAX_STRINGS);
+    if (label_strings == NULL) {
+	fprintf(stderr, "tack: out of memory\n");
+	ExitProgram(EXIT_FAILURE);
+    }
 
 #if TACK_CAN_EDIT
     copy_termtype(&original_term, CUR_TP);
@@ -730,7 +1007,7 @@ edit_init(void)
 	xon_index = nt->nt_index;
     }
     xon_shadow = xon_xoff;
-    FreeIfNeeded(label_strings);
+    free(label_strings);
 }
 
 #if TACK_CAN_EDIT
@@ -880,6 +1157,128 @@ form_terminfo(const char *srcp)
     return (buffer);
 }
 
+/*
+**	format_change(buf, change, saved)
+**
+**	Format the original (saved) or current value of a changed cap in
+**	terminfo source form.  A cap which is not defined is cancelled.
+*/
+static void
+format_change(
+		 char *buf,
+		 const CHANGE_TABLE * p,
+		 int saved)
+{
+    int x = p->ct_index;
+    int v;
+    const char *value;
+
+    switch (p->ct_type) {
+    case BOOLEAN:
+	v = (saved
+	     ? get_saved_boolean(x)
+	     : ((x == xon_index) ? xon_shadow : get_newer_boolean(x)));
+	sprintf(buf, "%s%s", boolnames[x], v ? "" : "@");
+	break;
+    case NUMBER:
+	v = saved ? get_saved_number(x) : get_newer_number(x);
+	if (v >= 0) {
+	    sprintf(buf, "%s#%d", numnames[x], v);
+	} else {
+	    sprintf(buf, "%s@", numnames[x]);
+	}
+	break;
+    case STRING:
+    default:
+	value = saved ? get_saved_string(x) : get_newer_string(x);
+	if (value) {
+	    sprintf(buf, "%s=%.*s", STR_NAME(x),
+		    TEMP_SIZE - NAME_SIZE - 2, form_terminfo(value));
+	} else {
+	    sprintf(buf, "%s@", STR_NAME(x));
+	}
+	break;
+    }
+}
+
+/*
+**	save_changes()
+**
+**	Write the caps which differ from the original terminfo to a file
+**	next to the one written by save_info().  Each change is written as
+**	the old value, prefixed by "-", followed by the new value, prefixed
+**	by "+".
+*/
+static void
+save_changes(void)
+{
+    int i;
+    FILE *fp;
+    char *name;
+    char buf[TEMP_SIZE];
+
+    if (!user_modified()) {
+	return;
+    }
+    name = (char *) malloc(strlen(tty_basename) + sizeof(DIFF_SUFFIX));
+    if (name == NULL) {
+	return;
+    }
+    sprintf(name, "%s%s", tty_basename, DIFF_SUFFIX);
+    if ((fp = fopen(name, "w")) == (FILE *) NULL) {
+	(void) sprintf(temp, "can't open: %.*s", TEMP_SIZE - 20, name);
+	ptextln(temp);
+	free(name);
+	return;
+    }
+    (void) fprintf(fp, "# Changes made by TACK to TERM=%s\n", tty_basename);
+    qsort(change_table, (size_t) change_count, sizeof(CHANGE_TABLE), compare_change);
+    for (i = 0; i < change_count; i++) {
+	const CHANGE_TABLE *p = &change_table[i];
+
+	if (cap_changed(p)) {
+	    format_change(buf, p, TRUE);
+	    (void) fprintf(fp, "-\t%s,\n", buf);
+	    format_change(buf, p, FALSE);
+	    (void) fprintf(fp, "+\t%s,\n", buf);
+	}
+    }
+    (void) fclose(fp);
+    sprintf(temp, "Changes saved as file: %.*s", TEMP_SIZE - 30, name);
+    ptextln(temp);
+    free(name);
+}
+
+/*
+**	save_compiled()
+**
+**	Write the current terminfo in compiled form to a private terminfo
+**	directory, so that other programs can load it with $TERMINFO set to
+**	that directory, without running tic.
+*/
+static void
+save_compiled(void)
+{
+    char names[TEMP_SIZE];
+    char path[TEMP_SIZE];
+    int xon_value = get_newer_boolean(xon_index);
+    int ok;
+
+    sprintf(names, "%.*s|%.*s", NAME_SIZE, tty_basename,
+	    TEMP_SIZE - NAME_SIZE - 2, longname());
+    /* xon is only shadowed while tack is running */
+    set_newer_boolean(xon_index, xon_shadow);
+    ok = tinfo_write(COMPILED_DIR, names, CUR_TP, &original_term, path);
+    set_newer_boolean(xon_index, xon_value);
+    if (ok) {
+	sprintf(temp, "Compiled terminfo saved as file: %.*s",
+		TEMP_SIZE - 40, path);
+    } else {
+	sprintf(temp, "can't write compiled terminfo in: %s", COMPILED_DIR);
+    }
+    ptextln(temp);
+}
+
 /*
 **	save_info(test_list, status, ch)
 **
@@ -931,6 +1330,8 @@ save_info(
     (void) fclose(fp);
     sprintf(temp, "Terminfo saved as file: %s", tty_basename);
     ptextln(temp);
+    save_changes();
+    save_compiled();
 }
 
 /*
@@ -1181,7 +1582,6 @@ show_value(
 	      int *ch)
 {
     NAME_TABLE const *nt;
-    char *s;
     int n, op;
     char buf[TEMP_SIZE];
     char tmp[TEMP_SIZE];
@@ -1203,6 +1603,7 @@ show_value(
 	switch (nt->nt_type) {
 	case BOOLEAN:
 	    if (op == SHOW_DELETE) {
+		mark_changed(BOOLEAN, nt->nt_index);
 		if (nt->nt_index == xon_index) {
 		    xon_shadow = 0;
 		} else {
@@ -1218,7 +1619,7 @@ show_value(
 	    break;
 	case STRING:
 	    if (op == SHOW_DELETE) {
-		set_newer_string(nt->nt_index, NULL);
+		patch_string(nt->nt_index, NULL);
 		return;
 	    }
 	    if (get_newer_string(nt->nt_index)) {
@@ -1230,6 +1631,7 @@ show_value(
 	    break;
 	case NUMBER:
 	    if (op == SHOW_DELETE) {
+		mark_changed(NUMBER, nt->nt_index);
 		set_newer_number(nt->nt_index, -1);
 		return;
 	    }
@@ -1251,6 +1653,7 @@ show_value(
     }
     if (nt->nt_type == BOOLEAN) {
 	ptextln("Value flipped");
+	mark_changed(BOOLEAN, nt->nt_index);
 	if (nt->nt_index == xon_index) {
 	    xon_shadow = !xon_shadow;
 	} else {
@@ -1265,15 +1668,14 @@ show_value(
     switch (nt->nt_type) {
     case STRING:
 	scan_terminfo(buf, tmp, tmp + sizeof(tmp));
-	s = (char *) malloc(strlen(tmp) + 1);
-	strcpy(s, tmp);
-	set_newer_string(nt->nt_index, s);
+	patch_string(nt->nt_index, tmp);
 	sprintf(temp, "new string value  %s", nt->nt_name);
 	ptextln(temp);
 	ptextln(expand(get_newer_string(nt->nt_index)));
 	break;
     case NUMBER:
 	if (sscanf(buf, "%d", &n) == 1) {
+	    mark_changed(NUMBER, nt->nt_index);
 	    set_newer_number(nt->nt_index, n);
 	    sprintf(temp, "new numeric value  %s %d",
 		    nt->nt_name, n);
@@ -1342,46 +1744,40 @@ show_changed(
     static char title[] = "                     old value   cap  new value";
     char abuf[TEMP_SIZE];
 
-    for (i = 0; i < MAX_BOOLEAN; i++) {
-	int v = (i == xon_index) ? xon_shadow : get_newer_boolean(i);
-	if (get_saved_boolean(i) != v) {
-	    if (header) {
-		ptextln(title);
-		header = 0;
-	    }
+    qsort(change_table, (size_t) change_count, sizeof(CHANGE_TABLE), compare_change);
+    for (i = 0; i < change_count; i++) {
+	const CHANGE_TABLE *p = &change_table[i];
+	int x = p->ct_index;
+
+	if (!cap_changed(p)) {
+	    continue;
+	}
+	if (header) {
+	    ptextln(title);
+	    header = 0;
+	}
+	switch (p->ct_type) {
+	case BOOLEAN:
 	    sprintf(temp, "%30d %6s %d",
-		    get_saved_boolean(i), boolnames[i], v);
+		    get_saved_boolean(x), boolnames[x],
+		    (x == xon_index) ? xon_shadow : get_newer_boolean(x));
 	    ptextln(temp);
-	}
-    }
-    for (i = 0; i < MAX_NUMBERS; i++) {
-	if (get_saved_number(i) != get_newer_number(i)) {
-	    if (header) {
-		ptextln(title);
-		header = 0;
-	    }
+	    break;
+	case NUMBER:
 	    sprintf(temp, "%30d %6s %d",
-		    get_saved_number(i), numnames[i],
-		    get_newer_number(i));
+		    get_saved_number(x), numnames[x],
+		    get_newer_number(x));
 	    ptextln(temp);
-	}
-    }
-    for (i = 0; i < (int) MAX_STRINGS; i++) {
-	const char *a;
-	const char *b;
-	if ((a = get_saved_string(i)) == NULL)
-	    a = "";
-	if ((b = get_newer_string(i)) == NULL)
-	    b = "";
-	if (strcmp(a, b)) {
-	    if (header) {
-		ptextln(title);
-		header = 0;
-	    }
-	    sprintf(abuf, "%.*s", (int) sizeof(abuf) - 1, form_terminfo(a));
+	    break;
+	case STRING:
+	default:
+	    sprintf(abuf, "%.*s", (int) sizeof(abuf) - 1,
+		    form_terminfo(get_saved_string(x) ? get_saved_string(x) : ""));
 	    sprintf(temp, "%.30s %6s %.30s",
-		    abuf, STR_NAME(i), form_terminfo(b));
+		    abuf, STR_NAME(x),
+		    form_terminfo(get_newer_string(x) ? get_newer_string(x) : ""));
 	    putln(temp);
+	    break;
 	}
     }
     if (header) {
@@ -1391,6 +1787,46 @@ show_changed(
     *ch = REQUEST_PROMPT;
 }
 
+/*
+**	retest_changed(test_list, status, ch)
+**
+**	Run the tests which use the caps that have been changed.
+*/
+static void
+retest_changed(
+		  TestList * t GCC_UNUSED,
+		  int *state,
+		  int *ch)
+{
+    int i, n = 0;
+    int *caps = (int *) calloc((size_t) change_count + 1, sizeof(int));
+
+    if (caps == NULL) {
+	return;
+    }
+    for (i = 0; i < change_count; i++) {
+	if (cap_changed(&change_table[i])) {
+	    caps[n++] = type_ordinal(change_table[i].ct_type,
+				     change_table[i].ct_index);
+	}
+    }
+    caps[n] = -1;
+    *ch = REQUEST_PROMPT;
+    if (n == 0) {
+	ptextln("No changes");
+    } else {
+	if (tty_can_sync == SYNC_NOT_TESTED) {
+	    verify_time();
+	}
+	if (menu_test_caps(NULL, caps, state, ch) == 0) {
+	    ptextln("No tests use the modified caps");
+	} else {
+	    *ch = '?';
+	}
+    }
+    free(caps);
+}
+
 /*
 **	change_one_entry(test_list, status, ch)
 **
@@ -1437,12 +1873,10 @@ change_one_entry(
 	ptextln("That string is not currently defined.  Please enter a new value, including the padding delay:");
 	read_string(buf, sizeof(buf));
 	scan_terminfo(buf, pad, pad + sizeof(pad));
-	t = (char *) malloc(strlen(pad) + 1);
-	strcpy(t, pad);
-	set_newer_string(x, t);
+	patch_string(x, pad);
 	sprintf(temp, "new string value  %s", STR_NAME(x));
 	ptextln(temp);
-	ptextln(expand(t));
+	ptextln(expand(get_newer_string(x)));
 	return;
     }
     sprintf(buf, "Current value: (%.*s) %s",
@@ -1506,12 +1940,12 @@ change_one_entry(
     if (pad[0]) {
 	sprintf(t, "$<%.*s>", 20, pad);
     }
-    if ((t = (char *) malloc(strlen(buf) + 1))) {
-	strcpy(t, buf);
-	set_newer_string(x, t);
-	if (i != 255) {
-	    tx_cap[i] = t;
-	}
+    patch_string(x, buf);
+    if (i != 255 && tx_cap[i] == current_string) {
+	/* a translated default (TM_*) is not the cap's value, so it was
+	   not swapped by value; replace it here */
+	tx_cap[i] = get_newer_string(x);
+	tx_delay[i] = msec_cost(tx_cap[i], tx_affected[i]);
     }
     generic_done_message(test, state, chp);
 }
@@ -1562,6 +1996,7 @@ TestList edit_test_list[] = {
     {SHOW_EDIT, 4, NULL, NULL, "e) edit value of a selected cap", show_value, NULL},
     {SHOW_DELETE, 3, NULL, NULL, "d) delete string", show_value, NULL},
     {0, 3, NULL, NULL, "m) show caps that have been modified", show_changed, NULL},
+    {MENU_CLEAR, 0, NULL, NULL, "r) retest caps that have been modified", retest_changed, NULL},
     {MENU_CLEAR + FLAG_CAN_TEST, 0, NULL, NULL, "c) show caps that can be tested", show_report, NULL},
     {MENU_CLEAR + FLAG_TESTED, 0, NULL, NULL, "t) show caps that have been tested", show_report, NULL},
     {MENU_CLEAR + FLAG_FUNCTION_KEY, 0, NULL, NULL, "f) show a list of function keys", show_report, NULL},
@@ -1584,11 +2019,8 @@ TestMenu change_pad_menu =
 void
 tack_edit_leaks(void)
 {
+#if TACK_CAN_EDIT
     free_termtype(&original_term);
-
-    FreeIfNeeded(label_strings);
-    FreeIfNeeded(flag_boolean);
-    FreeIfNeeded(flag_numbers);
-    FreeIfNeeded(flag_strings);
+#endif
 }
 #endif
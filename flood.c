@@ -0,0 +1,257 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+
+#include <tack.h>
+
+#include <sys/wait.h>
+
+MODULE_ID("$Id: flood.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Host-bound input throughput.
+ *
+ * The other input tests read one key or one report at a time.  This test
+ * makes the terminal send a large volume of input: the replies to many
+ * device attribute (DA) requests, and to many answerback (ENQ) requests.
+ * A bracketed paste is simulated by a child process which writes into a
+ * pseudo-terminal, since tack cannot make the terminal paste.
+ *
+ * The terminal's replies are measured with XON/XOFF flow control off and
+ * on in the tty driver, as tty_set() would select it.  The number of
+ * characters lost is the difference between what was expected and what
+ * arrived.  The paste measures only throughput: a write to the master side
+ * of a pseudo-terminal blocks while the slave's input queue is full, so
+ * nothing is lost, and the slave's XON/XOFF setting makes no difference.
+ */
+
+#define FLOOD_REQUESTS	500	/* requests sent to the terminal */
+#define FLOOD_CHUNK	20	/* requests sent between reads */
+#define FLOOD_PASTE	(256 * 1024)	/* characters in the paste */
+#define FLOOD_LINE	64	/* characters in a line of the paste */
+#define FLOOD_IDLE	500000L	/* microseconds without input at the end */
+#define FLOOD_BUFFER	4096
+
+#define PASTE_START	"\033[200~"
+#define PASTE_END	"\033[201~"
+
+#define FLOOD_DA	0	/* device attributes */
+#define FLOOD_ENQ	1	/* answerback */
+#define FLOOD_PTY	2	/* paste through a pseudo-terminal */
+#define FLOOD_last	3
+
+static const char *flood_name[FLOOD_last] =
+{
+    "DA replies",
+    "answerback (ENQ)",
+    "paste (pty)"
+};
+
+typedef struct {
+    int tested;			/* TRUE if the source could be measured */
+    long expected;		/* characters which should have arrived */
+    long received;		/* characters which did */
+    long usec;			/* time until the last of them */
+} FloodResult;
+
+/*
+**	flood_terminal(request, result)
+**
+**	Send many copies of a request to the terminal, reading the replies
+**	as they arrive.  Return FALSE if the terminal does not reply.
+*/
+static int
+flood_terminal(
+		  const char *request,
+		  FloodResult * r)
+{
+    char buf[FLOOD_BUFFER];
+    int reply, sent, got;
+
+    spin_flush();
+    tc_putp(request);
+    if ((reply = read_reply(buf, sizeof(buf))) <= 0) {
+	return FALSE;
+    }
+    r->expected = (long) reply * FLOOD_REQUESTS;
+
+    event_start(TIME_TEST);
+    for (sent = 0; sent < FLOOD_REQUESTS;) {
+	int n;
+
+	for (n = 0; n < FLOOD_CHUNK && sent < FLOOD_REQUESTS; n++, sent++) {
+	    tc_putp(request);
+	}
+	flush_output();
+	while ((got = tty_read_input(fileno(stdin), buf, sizeof(buf), 0L)) > 0) {
+	    r->received += got;
+	    r->usec = event_time(TIME_TEST);
+	}
+    }
+    while ((got = tty_read_input(fileno(stdin), buf, sizeof(buf), FLOOD_IDLE)) > 0) {
+	r->received += got;
+	r->usec = event_time(TIME_TEST);
+    }
+    return TRUE;
+}
+
+/*
+**	paste_writer(master)
+**
+**	In the child process, write a bracketed paste of many lines as fast
+**	as the pseudo-terminal accepts it.  Wait to be killed.
+*/
+static void
+paste_writer(int master)
+{
+    char buf[FLOOD_BUFFER];
+    long sent;
+    int n;
+
+    for (n = 0; n < (int) sizeof(buf); n++) {
+	buf[n] = (char) (((n % FLOOD_LINE) == FLOOD_LINE - 1)
+			 ? '\r'
+			 : ('a' + (n % 26)));
+    }
+    IGNORE_RC(write(master, PASTE_START, strlen(PASTE_START)));
+    for (sent = 0; sent < FLOOD_PASTE; sent += (long) sizeof(buf)) {
+	IGNORE_RC(write(master, buf, sizeof(buf)));
+    }
+    IGNORE_RC(write(master, PASTE_END, strlen(PASTE_END)));
+    for (;;) {
+	pause();
+    }
+}
+
+/*
+**	flood_paste(result)
+**
+**	Read a bracketed paste written into a pseudo-terminal.  Return FALSE
+**	if the pseudo-terminal cannot be used.
+*/
+static int
+flood_paste(FloodResult * r)
+{
+    char buf[FLOOD_BUFFER];
+    int master, slave, got;
+    pid_t pid;
+
+    if (!tty_open_pty(&master, &slave)) {
+	return FALSE;
+    }
+    r->expected = FLOOD_PASTE + (long) (strlen(PASTE_START) + strlen(PASTE_END));
+    flush_output();
+    event_start(TIME_TEST);
+    if ((pid = fork()) < 0) {
+	close(master);
+	close(slave);
+	return FALSE;
+    }
+    if (pid == 0) {
+	close(slave);
+	paste_writer(master);
+	_exit(EXIT_SUCCESS);
+    }
+    while (r->received < r->expected
+	   && (got = tty_read_input(slave, buf, sizeof(buf), FLOOD_IDLE)) > 0) {
+	r->received += got;
+	r->usec = event_time(TIME_TEST);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, (int *) 0, 0);
+    close(slave);
+    close(master);
+    return TRUE;
+}
+
+/*
+**	input_flood(test_list, status, ch)
+**
+**	Measure the sustained rate of input from each source, with XON/XOFF
+**	off and on, and how much of it is lost.
+*/
+void
+input_flood(
+	       TestList * t,
+	       int *state,
+	       int *ch)
+{
+    FloodResult result[FLOOD_last][2];
+    int save_xon = select_xon_xoff;
+    int source, xon;
+
+    put_clear();
+    ptextln("Flooding the input.  This takes a few seconds.");
+    memset(result, 0, sizeof(result));
+    for (xon = 0; xon < 2; xon++) {
+	select_xon_xoff = xon;
+	tty_set();
+	result[FLOOD_DA][xon].tested =
+	    flood_terminal("\033[c", &result[FLOOD_DA][xon]);
+	result[FLOOD_ENQ][xon].tested =
+	    flood_terminal("\005", &result[FLOOD_ENQ][xon]);
+    }
+    select_xon_xoff = save_xon;
+    tty_set();
+    spin_flush();
+    /* the paste cannot lose characters, so it is run once */
+    result[FLOOD_PTY][0].tested = flood_paste(&result[FLOOD_PTY][0]);
+
+    put_crlf();
+    ptextln("source             XON/XOFF  characters   chars/sec      lost");
+    for (source = 0; source < FLOOD_last; source++) {
+	for (xon = 0; xon < 2; xon++) {
+	    FloodResult *r = &result[source][xon];
+	    const char *mode = xon ? "on" : "off";
+	    char lost[20];
+
+	    if (source == FLOOD_PTY) {
+		if (xon) {
+		    continue;
+		}
+		mode = "-";
+		strcpy(lost, "-");
+	    } else {
+		sprintf(lost, "%ld",
+			(r->expected > r->received)
+			? (r->expected - r->received)
+			: 0L);
+	    }
+	    if (!r->tested) {
+		sprintf(temp, "%-18s %-8s  no reply",
+			flood_name[source], mode);
+	    } else {
+		sprintf(temp, "%-18s %-8s %11ld %11lu %9s",
+			flood_name[source], mode,
+			r->received,
+			(unsigned long) sliding_scale((int) r->received, 1000000,
+						      (unsigned long) (r->usec
+								       ? r->usec
+								       : 1)),
+			lost);
+	    }
+	    ptextln(temp);
+	}
+    }
+    put_crlf();
+    ptextln("Characters are lost when the terminal sends faster than tack reads, and neither side uses flow control.");
+    ptextln("The paste through a pseudo-terminal measures only throughput: its writer waits when the input queue is full.");
+    generic_done_message(t, state, ch);
+}
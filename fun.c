@@ -21,6 +21,17 @@
 
 #include <tack.h>
 
+#include <sys/wait.h>
+
+#if HAVE_SELECT
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#if HAVE_SYS_SELECT_H
+#include <sys/select.h>
+#endif
+#endif
+
 MODULE_ID("$Id: fun.c,v 1.33 2025/04/26 23:31:56 tom Exp $")
 
 #define COPY_1(target, source) sprintf(target, "%.*s", (int)sizeof(target) - 1, source)
@@ -31,6 +42,7 @@ MODULE_ID("$Id: fun.c,v 1.33 2025/04/26 23:31:56 tom Exp $")
  */
 
 static void funkey_keys(TestList *, int *, int *);
+static void funkey_burst(TestList *, int *, int *);
 static void funkey_meta(TestList *, int *, int *);
 static void funkey_label(TestList *, int *, int *);
 static void funkey_prog(TestList *, int *, int *);
@@ -40,6 +52,8 @@ TestList funkey_test_list[] = {
     MY_EDIT_MENU
     {MENU_CLEAR + FLAG_FUNCTION_KEY, 0, NULL, NULL, "f) show a list of function keys", show_report, NULL},
     {MENU_NEXT | MENU_CLEAR, 0, "smkx) (rmkx", NULL, "k) test function keys", funkey_keys, NULL},
+    {MENU_CLEAR, 0, NULL, NULL, "b) function key bursts", funkey_burst, NULL},
+    {MENU_CLEAR, 0, NULL, NULL, "i) host-bound input flood", input_flood, NULL},
     {MENU_NEXT, 10, "km", "smm rmm", NULL, funkey_meta, NULL},
     {MENU_NEXT, 8, "nlab) (smln) (pln) (rmln", "lw lh", NULL, funkey_label, NULL},
     {MENU_NEXT, 2, "pfx", NULL, NULL, funkey_prog, NULL},
@@ -63,6 +77,7 @@ static const char **fk_name;
 static char **fkval;
 static char **fk_label;		/* function key labels (if any) */
 static int *fk_tested;
+static int *fk_saved;		/* fk_tested, kept during the burst test */
 static size_t num_strings = 0;
 
 static size_t fkmax = 1;	/* length of longest key */
@@ -84,10 +99,16 @@ alloc_strings(void)
 {
     if (num_strings != MAX_STRINGS) {
 	num_strings = MAX_STRINGS;
-	fk_name = (const char **) calloc(num_strings, sizeof(const char *));
-	fkval = (char **) calloc(num_strings, sizeof(char *));
-	fk_label = (char **) calloc(num_strings, sizeof(char *));
-	fk_tested = (int *) calloc(num_strings, sizeof(int));
+	fk_name = (const char **) arena_alloc(&session_arena,
+					      num_strings * sizeof(const char *));
+	fkval = (char **) arena_alloc(&session_arena,
+				      num_strings * sizeof(char *));
+	fk_label = (char **) arena_alloc(&session_arena,
+					 num_strings * sizeof(char *));
+	fk_tested = (int *) arena_alloc(&session_arena,
+					num_strings * sizeof(int));
+	fk_saved = (int *) arena_alloc(&session_arena,
+				       num_strings * sizeof(int));
     }
 }
 
@@ -430,9 +451,7 @@ found_exit(char *keybuf, int hx, int cc)
     for (j = 0; j < MAX_FK_UNK; j++) {
 	if (j == funk) {
 	    fk_length[funk] = expand_chars;
-	    if ((fk_unknown[funk] = (char *) malloc(strlen(s) + 1))) {
-		strcpy(fk_unknown[funk++], s);
-	    }
+	    fk_unknown[funk++] = arena_strdup(&session_arena, s);
 	    break;
 	}
 	if (fk_length[j] == expand_chars) {
@@ -485,6 +504,419 @@ funkey_keys(
     generic_done_message(t, state, ch);
 }
 
+/*
+ * Function key bursts.
+ *
+ * A child process writes the function key strings into a pseudo-terminal
+ * at a fixed rate, or back-to-back, while tack reads the other side as the
+ * bytes arrive.  The byte stream is decoded with found_match(), which is
+ * what funkey_keys() uses: bytes are collected until no longer key begins
+ * with them, and then matched against the keys.  A key is decoded correctly
+ * if the match is the key which was sent, at its place in the stream.  The
+ * latency is the time from when the key was written until its last byte
+ * was read.
+ *
+ * Keys which arrive in more than one read (split), and reads which return
+ * more than one key (merged), are counted, since a decoder which relies on
+ * the timing of the input would mis-parse them.
+ */
+
+#define BURST_KEYS	20	/* keys sent at each rate */
+#define BURST_LEAD	20000	/* microseconds before the first key */
+#define BURST_WAIT	100000	/* microseconds to wait for a longer key */
+#define BURST_DONE	1000000	/* microseconds after the last key is due */
+
+#define BURST_EXACT	1	/* the pending bytes are a key */
+#define BURST_LONGER	2	/* a longer key begins with them */
+
+/* keys per second; zero means back-to-back */
+static const int burst_rates[] =
+{2, 5, 10, 50, 200, 1000, 0};
+
+#define NUM_RATES	(int) (sizeof(burst_rates) / sizeof(burst_rates[0]))
+
+static int burst_shift;		/* the rates are doubled this many times */
+static int burst_next;		/* the next key to send */
+
+typedef struct {
+    int rate;			/* keys per second, or zero */
+    int correct;		/* keys decoded correctly */
+    int wrong;			/* keys decoded as something else */
+    int lost;			/* keys which were not read at all */
+    int split;			/* keys divided between reads */
+    int merged;			/* reads which returned more than one key */
+    long latency;		/* sum of the latencies, in microseconds */
+    long worst;			/* the longest latency */
+} BurstResult;
+
+typedef struct {
+    int keys[BURST_KEYS];	/* the index in fkval[] of each key sent */
+    int start[BURST_KEYS + 1];	/* the offset of each key in the stream */
+    int done[BURST_KEYS];	/* TRUE if the key was decoded, or not */
+    long gap;			/* microseconds between keys */
+    char pending[40];		/* bytes which are not yet decoded */
+    int used;			/* the number of pending bytes */
+    int from;			/* the offset of the pending bytes */
+    long arrived;		/* when the last pending byte was read */
+} BurstStream;
+
+/*
+**	burst_usable(value)
+**
+**	Return TRUE if the key string can be sent and matched unchanged.
+*/
+static int
+burst_usable(const char *value)
+{
+    if (!VALID_STRING(value) || strlen(value) >= 32) {
+	return FALSE;
+    }
+    for (; *value != '\0'; value++) {
+	if ((UChar(*value) & char_mask) != UChar(*value)
+	    || (*value & 0x7f) == 0) {
+	    return FALSE;
+	}
+    }
+    return TRUE;
+}
+
+/*
+**	burst_sleep(usec)
+**
+**	Wait for a time, rounded down to avoid oversleeping.
+*/
+static void
+burst_sleep(long usec)
+{
+#if HAVE_SELECT
+    struct timeval tv;
+
+    usec -= 1000;
+    if (usec > 0) {
+	tv.tv_sec = usec / 1000000;
+	tv.tv_usec = usec % 1000000;
+	(void) select(0, NULL, NULL, NULL, &tv);
+    }
+#else
+    (void) usec;
+#endif
+}
+
+/*
+**	burst_writer(master, keys, count, gap)
+**
+**	In the child process, write the keys with the given gap between them,
+**	measured from the start of the TIME_KEYS timer.  Wait to be killed.
+*/
+static void
+burst_writer(
+		int master,
+		const int *keys,
+		int count,
+		long gap)
+{
+    int n;
+
+    for (n = 0; n < count; n++) {
+	long due = BURST_LEAD + (n * gap);
+	long now;
+
+	while ((now = event_time(TIME_KEYS)) < due) {
+	    burst_sleep(due - now);
+	}
+	IGNORE_RC(write(master, fkval[keys[n]], strlen(fkval[keys[n]])));
+    }
+    for (;;) {
+	burst_sleep(1000000L);
+    }
+}
+
+/*
+**	burst_match(pending, used)
+**
+**	Return BURST_LONGER if a key longer than the pending bytes begins with
+**	them, BURST_EXACT if they are a key, or zero.
+*/
+static int
+burst_match(
+	       const char *pending,
+	       int used)
+{
+    int j;
+    int result = 0;
+
+    for (j = 0; j < key_count; j++) {
+	if (fkval[j] != NULL && !strncmp(fkval[j], pending, (size_t) used)) {
+	    if ((int) strlen(fkval[j]) > used) {
+		return BURST_LONGER;
+	    }
+	    result = BURST_EXACT;
+	}
+    }
+    return result;
+}
+
+/*
+**	burst_decode(result, stream, length)
+**
+**	Decode the first length pending bytes, and remove them.  Count the
+**	keys which they cover, as correct if they match the key which was
+**	sent there, or as wrong.
+*/
+static void
+burst_decode(
+		BurstResult * r,
+		BurstStream * b,
+		int length)
+{
+    int end = b->from + length;
+    char save = b->pending[length];
+    int matched;
+    int k;
+
+    b->pending[length] = '\0';
+    fresh_line();
+    matched = found_match(b->pending, hex_out, 0);
+    b->pending[length] = save;
+    for (k = 0; k < BURST_KEYS && b->start[k + 1] <= b->from; k++) ;
+    if (matched
+	&& k < BURST_KEYS
+	&& b->start[k] == b->from
+	&& b->start[k + 1] == end
+	&& !strncmp(b->pending, fkval[b->keys[k]], (size_t) length)) {
+	long latency = b->arrived - (BURST_LEAD + (k * b->gap));
+
+	r->correct++;
+	r->latency += latency;
+	if (latency > r->worst) {
+	    r->worst = latency;
+	}
+	b->done[k] = TRUE;
+    } else {
+	for (; k < BURST_KEYS && b->start[k] < end; k++) {
+	    if (!b->done[k]) {
+		r->wrong++;
+		b->done[k] = TRUE;
+	    }
+	}
+    }
+    b->used -= length;
+    b->from = end;
+    memmove(b->pending, b->pending + length, (size_t) b->used);
+}
+
+/*
+**	burst_byte(result, stream, ch)
+**
+**	Add a byte to the pending bytes, and decode them if no longer key
+**	begins with them.  If they are not a key, decode the bytes before
+**	this one, and keep it for the next key.
+*/
+static void
+burst_byte(
+	      BurstResult * r,
+	      BurstStream * b,
+	      int ch)
+{
+    int match;
+
+    b->pending[b->used++] = (char) ch;
+    match = burst_match(b->pending, b->used);
+    if (match == 0 && b->used > 1) {
+	burst_decode(r, b, b->used - 1);
+	match = burst_match(b->pending, b->used);
+    }
+    if (match != BURST_LONGER || b->used >= (int) sizeof(b->pending) - 1) {
+	burst_decode(r, b, b->used);
+    }
+}
+
+/*
+**	burst_run(result)
+**
+**	Send a burst of keys at the result's rate through a pseudo-terminal,
+**	and decode them.  Return FALSE if the pseudo-terminal cannot be used.
+*/
+static int
+burst_run(BurstResult * r)
+{
+    BurstStream b;
+    int master, slave, n, k, pos;
+    long last;
+    pid_t pid;
+    char buf[256];
+
+    memset(&b, 0, sizeof(b));
+    b.gap = r->rate ? (1000000L / r->rate) : 0;
+    for (n = 0, pos = 0; n < BURST_KEYS; n++) {
+	do {
+	    k = burst_next++ % key_count;
+	} while (!burst_usable(fkval[k]));
+	b.keys[n] = k;
+	b.start[n] = pos;
+	pos += (int) strlen(fkval[k]);
+    }
+    b.start[BURST_KEYS] = pos;
+    last = BURST_LEAD + ((BURST_KEYS - 1) * b.gap) + BURST_DONE;
+
+    if (!tty_open_pty(&master, &slave)) {
+	return FALSE;
+    }
+    flush_output();
+    event_start(TIME_KEYS);
+    if ((pid = fork()) < 0) {
+	close(master);
+	close(slave);
+	return FALSE;
+    }
+    if (pid == 0) {
+	close(slave);
+	burst_writer(master, b.keys, BURST_KEYS, b.gap);
+	_exit(EXIT_SUCCESS);
+    }
+
+    for (pos = 0; pos < b.start[BURST_KEYS] || b.used > 0;) {
+	int got = tty_read_input(slave, buf, sizeof(buf), BURST_WAIT);
+
+	if (got <= 0) {
+	    /* nothing more came: decode what is pending */
+	    if (b.used > 0) {
+		burst_decode(r, &b, b.used);
+	    } else if (event_time(TIME_KEYS) > last) {
+		break;
+	    }
+	    continue;
+	}
+	b.arrived = event_time(TIME_KEYS);
+	for (k = 0; k < BURST_KEYS && b.start[k + 1] <= pos; k++) ;
+	for (n = k; n < BURST_KEYS && b.start[n] < pos + got; n++) {
+	    /* count a split key once, at its first part */
+	    if (b.start[n] >= pos && b.start[n + 1] > pos + got) {
+		r->split++;
+	    }
+	}
+	if (n - k > 1) {
+	    r->merged++;
+	}
+	for (n = 0; n < got; n++) {
+	    burst_byte(r, &b, UChar(buf[n]));
+	}
+	pos += got;
+    }
+    for (k = 0; k < BURST_KEYS; k++) {
+	if (!b.done[k]) {
+	    r->lost++;
+	}
+    }
+
+    kill(pid, SIGKILL);
+    waitpid(pid, (int *) 0, 0);
+    close(slave);
+    close(master);
+    return TRUE;
+}
+
+/*
+**	funkey_burst(test_list, status, ch)
+**
+**	Send bursts of function keys through a pseudo-terminal at increasing
+**	rates, and report how many of them tack's key decoder recognized, and
+**	how long it took.  The keys are not marked as tested.
+*/
+static void
+funkey_burst(
+		TestList * t,
+		int *state,
+		int *ch)
+{
+    BurstResult result[NUM_RATES];
+    int n, usable, best;
+
+    for (n = usable = 0; n < key_count; n++) {
+	if (burst_usable(fkval[n])) {
+	    usable++;
+	}
+    }
+    if (usable == 0) {
+	ptext("There are no function keys to send.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+    if (scan_mode) {
+	ptext("The burst test does not decode scan codes.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+    while (1) {
+	put_clear();
+	sprintf(temp, "Sending %d of the %d function keys at each rate.",
+		BURST_KEYS, usable);
+	ptextln(temp);
+	best = 0;
+	end_state = 0;
+	memcpy(fk_saved, fk_tested, sizeof(int) * (size_t) key_count);
+	for (n = 0; n < NUM_RATES; n++) {
+	    BurstResult *r = &result[n];
+
+	    memset(r, 0, sizeof(*r));
+	    if (burst_rates[n]) {
+		r->rate = (burst_shift >= 0)
+		    ? (burst_rates[n] << burst_shift)
+		    : (burst_rates[n] >> -burst_shift);
+		if (r->rate < 1) {
+		    r->rate = 1;
+		}
+	    }
+	    if (!burst_run(r)) {
+		memcpy(fk_tested, fk_saved, sizeof(int) * (size_t) key_count);
+		ptext("A pseudo-terminal cannot be opened.  ");
+		generic_done_message(t, state, ch);
+		return;
+	    }
+	}
+	memcpy(fk_tested, fk_saved, sizeof(int) * (size_t) key_count);
+	fresh_line();
+	put_crlf();
+	ptextln("keys/sec   correct  wrong   lost  split merged  latency usec (mean, worst)");
+	for (n = 0; n < NUM_RATES; n++) {
+	    BurstResult *r = &result[n];
+	    char rate[20];
+
+	    if (r->rate) {
+		sprintf(rate, "%8d", r->rate);
+	    } else {
+		strcpy(rate, "no gaps");
+	    }
+	    sprintf(temp, "%-8s %6d/%d %6d %6d %6d %6d  %8ld %8ld",
+		    rate, r->correct, BURST_KEYS, r->wrong, r->lost,
+		    r->split, r->merged,
+		    r->correct ? (r->latency / r->correct) : 0L,
+		    r->worst);
+	    ptextln(temp);
+	    if (r->correct == BURST_KEYS && r->rate > best) {
+		best = r->rate;
+	    }
+	}
+	put_crlf();
+	if (best) {
+	    sprintf(temp, "The key decoder read every key correctly at up to %d keys/sec.", best);
+	} else {
+	    strcpy(temp, "The key decoder did not read every key correctly at any rate.");
+	}
+	ptextln(temp);
+	ptextln("Split keys and merged reads are not errors for this decoder.");
+	ptextln("[r] to repeat, [>] to double the rates, [<] to halve them, anything else to go to next test.  ");
+	generic_done_message(t, state, ch);
+	if (*ch == '>') {
+	    burst_shift++;
+	} else if (*ch == '<') {
+	    burst_shift--;
+	} else if (*ch != 'r') {
+	    break;
+	}
+    }
+}
+
 int
 tty_meta_prep(void)
 {				/* print a warning before the meta key test */
@@ -962,14 +1394,3 @@ tools_report(
 	ptextln("End of echo test.");
     }
 }
-
-#if NO_LEAKS
-void
-tack_fun_leaks(void)
-{
-    FreeIfNeeded(fk_name);
-    FreeIfNeeded(fkval);
-    FreeIfNeeded(fk_label);
-    FreeIfNeeded(fk_tested);
-}
-#endif
@@ -140,7 +140,7 @@ reset_init(void)
     }
     put_name(init_3string, " (is3)");
 
-    fflush(stdout);
+    flush_output();
 }
 
 /*
@@ -209,18 +209,58 @@ display_basic(void)
     putln(temp);
 }
 
+#if !USE_CURSES_ARRAYS
+#define MAX_NAMES 200
+
 /*
- * Conventional infocmp (Unix or ncurses) will print a comment at the
- * beginning of the terminal description, where the pathname of the terminfo
- * information is after a "file" or "file:" keyword.
+ * Add a cap name to the table for its type, unless it is already there.
  */
-static char *
-ask_infocmp(void)
+static void
+add_name(NAME_TYPE type, const char *name)
+{
+    char **table;
+    size_t *count;
+    size_t n;
+
+    switch (type) {
+    case BOOLEAN:
+	table = boolnames;
+	count = &max_booleans;
+	break;
+    case NUMBER:
+	table = numnames;
+	count = &max_numbers;
+	break;
+    default:
+	table = strnames;
+	count = &max_strings;
+	break;
+    }
+    for (n = 0; n < *count; ++n) {
+	if (!strcmp(table[n], name))
+	    return;
+    }
+    if (*count < MAX_NAMES) {
+	table[(*count)++] = arena_strdup(&session_arena, name);
+    }
+}
+
+/*
+ * This curses library does not provide the cap names.  Compiled entries do
+ * not store the names of the standard caps, so read those from infocmp.
+ * Add the extended names from the compiled entry, since infocmp may not
+ * show those.
+ */
+static void
+ask_infocmp(const char *path)
 {
-    char *result = NULL;
     size_t need = strlen(tty_basename) + 20;
     char *command = malloc(need);
 
+    boolnames = arena_alloc(&session_arena, MAX_NAMES * sizeof(*boolnames));
+    numnames = arena_alloc(&session_arena, MAX_NAMES * sizeof(*numnames));
+    strnames = arena_alloc(&session_arena, MAX_NAMES * sizeof(*strnames));
+
     if (command != NULL) {
 	FILE *pp;
 
@@ -229,65 +269,34 @@ ask_infocmp(void)
 	    char buffer[BUFSIZ];
 	    char *s, *t;
 
-	    if (fgets(buffer, (int) (sizeof(buffer) - 1), pp) != NULL
-		&& *buffer == '#'
-		&& ((t = strstr(buffer, " file: "))
-		    || (t = strstr(buffer, " file "))
-		    || ((t = strstr(buffer, " Reconstructed "))
-			&& (t = strstr(t, " from "))))
-		&& (s = strchr(buffer, '\n')) != NULL) {
-		*s = '\0';
-		s = strchr(t + 1, ' ');
-		result = strdup(s + 1);
-	    }
-#if !USE_CURSES_ARRAYS
-	    if (result) {
-		int max_b = 200;
-		int max_n = 200;
-		int max_s = 200;
-		boolnames = calloc((size_t) max_b, sizeof(*boolnames));
-		numnames = calloc((size_t) max_n, sizeof(*numnames));
-		strnames = calloc((size_t) max_s, sizeof(*strnames));
-		while (fgets(buffer, sizeof(buffer) - 1, pp) != 0) {
-		    int mytype = BOOLEAN;
-		    if (*buffer != '\t')
-			continue;
-		    for (s = buffer; isspace(UChar(*s)); ++s) ;
-		    for (t = s; *t != '\0'; ++t) {
-			if (strchr("@,", *t)) {
-			    *t = '\0';
-			    break;
-			} else if (*t == '#') {
-			    mytype = NUMBER;
-			    *t = '\0';
-			    break;
-			} else if (*t == '=') {
-			    mytype = STRING;
-			    *t = '\0';
-			    break;
-			}
-		    }
-		    s = strdup(s);
-		    switch (mytype) {
-		    case 0:
-			boolnames[max_booleans++] = s;
+	    while (fgets(buffer, sizeof(buffer) - 1, pp) != 0) {
+		NAME_TYPE mytype = BOOLEAN;
+		if (*buffer != '\t')
+		    continue;
+		for (s = buffer; isspace(UChar(*s)); ++s) ;
+		for (t = s; *t != '\0'; ++t) {
+		    if (strchr("@,", *t)) {
+			*t = '\0';
 			break;
-		    case 1:
-			numnames[max_numbers++] = s;
+		    } else if (*t == '#') {
+			mytype = NUMBER;
+			*t = '\0';
 			break;
-		    case 2:
-			strnames[max_strings++] = s;
+		    } else if (*t == '=') {
+			mytype = STRING;
+			*t = '\0';
 			break;
 		    }
 		}
+		add_name(mytype, s);
 	    }
-#endif
 	    pclose(pp);
 	}
 	free(command);
     }
-    return result;
+    (void) tinfo_extended(path, add_name);
 }
+#endif
 
 /*
  * ncurses initializes acs_map[] in setupterm; Unix curses does not.
@@ -425,10 +434,12 @@ curses_setup(
     tty_cps = (tty_baud_rate << 1) / (unsigned) tty_frame_size;
 
     /*
-     * "everyone" has infocmp, and its first line of output should be a
-     * comment telling which database is used.
+     * Find the file which setupterm used, searching as it does.
      */
-    tty_name = ask_infocmp();
+    tty_name = tinfo_locate(tty_basename);
+#if !USE_CURSES_ARRAYS
+    ask_infocmp(tty_name);
+#endif
 
     /* set up the defaults */
     replace_mode = TRUE;
@@ -439,7 +450,7 @@ curses_setup(
     /* Don't change the XON/XOFF modes yet. */
     select_xon_xoff = initial_stty_query(TTY_XON_XOFF) ? 1 : needs_xon_xoff;
 
-    fflush(stdout);		/* flush any output */
+    flush_output();		/* flush any output */
     tty_set();
 
     go_home();			/* set can_go_home */
@@ -454,7 +465,7 @@ curses_setup(
      * pads.  (Because that part of the test comes much later.)  Because
      * of this, I allow the terminal some time to catch up.
      */
-    fflush(stdout);		/* waste some time */
+    flush_output();		/* waste some time */
     sleep(1);			/* waste more time */
     charset_can_test();
     can_test("lines cols cr nxon rf if iprog rmp smcup rmcup", FLAG_CAN_TEST);
@@ -464,16 +475,7 @@ curses_setup(
 	tc_putp(enter_ca_mode);
 	put_clear();		/* just in case we switched pages */
     }
-    /*
-     * "everyone" has infocmp, and its first line of output should be a
-     * comment telling which database is used.
-     */
-    if (tty_name != NULL) {
-	ptext("Using terminfo from: ");
-	ptextln(tty_name);
-	put_crlf();
-	free(tty_name);
-    }
+    tinfo_report(tty_name);
 
     if (tty_can_sync == SYNC_NEEDED) {
 	verify_time();
@@ -503,14 +505,13 @@ bye_kids(int n)
 	    tc_putp(exit_xon_mode);
 	}
     }
-    if (debug_fp) {
-	fclose(debug_fp);
-	debug_fp = NULL;
-    }
+    trace_close();
     if (log_fp) {
 	fclose(log_fp);
 	log_fp = NULL;
     }
+    record_close();
+    cache_close();
     tty_reset();
     fclose(stdin);
     fclose(stdout);
@@ -29,6 +29,21 @@ MODULE_ID("$Id: menu.c,v 1.14 2025/04/26 23:31:56 tom Exp $")
 
 static void test_byname(TestMenu *, int *, int *);
 
+#define MAX_BYNAME	32	/* caps in one test_byname() request */
+
+/*
+ * The inverted index built by menu_can_scan(), listing the tests which use
+ * each cap in the order they appear in the menu tree.
+ */
+typedef struct _test_use {
+    struct _test_use *next;
+    TestList *test;
+    int order;			/* position of the test in the menu tree */
+} TestUse;
+
+static TestUse **cap_tests;	/* tests for each cap_ordinal() */
+static int test_order;		/* number of tests indexed */
+
 TestList *augment_test;
 char prompt_string[80];		/* menu prompt storage */
 
@@ -334,53 +349,163 @@ subtest_menu(
 }
 
 /*
-**	menu_can_scan(menu-structure)
+**	index_test(test, names)
+**
+**	Add the test to the cap-to-test index for each cap in the name list.
+*/
+static void
+index_test(
+	      TestList * test,
+	      const char *names)
+{
+    int caps[MAX_BYNAME];
+    int n;
+
+    cap_ordinals(names, caps, MAX_BYNAME);
+    for (n = 0; caps[n] >= 0; n++) {
+	TestUse **tail;
+
+	for (tail = &cap_tests[caps[n]]; *tail != NULL; tail = &(*tail)->next) {
+	    if ((*tail)->test == test) {
+		break;
+	    }
+	}
+	if (*tail == NULL) {
+	    *tail = (TestUse *) arena_alloc(&session_arena, sizeof(TestUse));
+	    (*tail)->test = test;
+	    (*tail)->order = test_order;
+	}
+    }
+}
+
+/*
+**	scan_menu(menu-structure)
 **
 **	Recursively scan the menu tree and find which cap names can be tested.
 */
-void
-menu_can_scan(
-		 const TestMenu * menu)
+static void
+scan_menu(
+	     const TestMenu * menu)
 {
     TestList *mt;
 
     for (mt = menu->tests; (mt->flags & MENU_LAST) == 0; mt++) {
 	can_test(mt->caps_done, FLAG_CAN_TEST);
 	can_test(mt->caps_tested, FLAG_CAN_TEST);
+	if (cap_tests != NULL && (mt->caps_done || mt->caps_tested)) {
+	    index_test(mt, mt->caps_done);
+	    index_test(mt, mt->caps_tested);
+	    test_order++;
+	}
 	if (!(mt->test_procedure)) {
 	    if (mt->sub_menu) {
-		menu_can_scan(mt->sub_menu);
+		scan_menu(mt->sub_menu);
 	    }
 	}
     }
 }
 
 /*
-**	menu_search(menu-structure, cap)
+**	menu_can_scan(menu-structure)
 **
-**	Recursively search the menu tree and execute any tests that use cap.
+**	Find which cap names can be tested, and build the index of the
+**	tests which use each cap.
 */
-static void
-menu_search(
-	       TestMenu * menu,
-	       int *state,
-	       int *ch,
-	       char *cap)
+void
+menu_can_scan(
+		 const TestMenu * menu)
+{
+    if (cap_tests == NULL) {
+	cap_tests = (TestUse **) arena_alloc(&session_arena,
+					     sizeof(TestUse *)
+					     * (size_t) MAX_CAPS);
+    }
+    scan_menu(menu);
+}
+
+static int
+compare_use(const void *a, const void *b)
+{
+    const TestUse *p = *(const TestUse * const *) a;
+    const TestUse *q = *(const TestUse * const *) b;
+    return p->order - q->order;
+}
+
+/*
+**	menu_contains(menu-structure, test)
+**
+**	Return TRUE if the test is in the menu or one of its sub-menus.
+*/
+static int
+menu_contains(
+		 const TestMenu * menu,
+		 const TestList * test)
 {
     TestList *mt;
-    int nch;
 
     for (mt = menu->tests; (mt->flags & MENU_LAST) == 0; mt++) {
-	nch = 0;
-	if (cap_match(mt->caps_done, cap)
-	    || cap_match(mt->caps_tested, cap)) {
-	    menu_test_loop(mt, state, &nch);
+	if (mt == test) {
+	    return TRUE;
 	}
-	if (!(mt->test_procedure)) {
-	    if (mt->sub_menu) {
-		menu_search(mt->sub_menu, state, &nch, cap);
+	if (!(mt->test_procedure)
+	    && mt->sub_menu
+	    && menu_contains(mt->sub_menu, test)) {
+	    return TRUE;
+	}
+    }
+    return FALSE;
+}
+
+/*
+**	menu_test_caps(menu, caps, state, ch)
+**
+**	Execute the tests that use any of the caps in the list, which is
+**	terminated with -1.  If a menu is given, only the tests in it and
+**	its sub-menus are used.  Each test is run once, in menu order.
+**	Return the number of tests found.
+*/
+int
+menu_test_caps(
+		  const TestMenu * menu,
+		  const int *caps,
+		  int *state,
+		  int *ch)
+{
+    TestUse **found;
+    TestUse *tu;
+    int n, count = 0, tests;
+
+    if (cap_tests == NULL) {
+	return 0;
+    }
+    for (n = 0; caps[n] >= 0; n++) {
+	for (tu = cap_tests[caps[n]]; tu != NULL; tu = tu->next) {
+	    if (menu == NULL || menu_contains(menu, tu->test)) {
+		count++;
 	    }
 	}
+    }
+    if (count == 0
+	|| (found = (TestUse **) calloc((size_t) count, sizeof(TestUse *))) == NULL) {
+	return 0;
+    }
+    for (n = count = 0; caps[n] >= 0; n++) {
+	for (tu = cap_tests[caps[n]]; tu != NULL; tu = tu->next) {
+	    if (menu == NULL || menu_contains(menu, tu->test)) {
+		found[count++] = tu;
+	    }
+	}
+    }
+    qsort(found, (size_t) count, sizeof(TestUse *), compare_use);
+    for (n = tests = 0; n < count; n++) {
+	if (tests == 0 || found[n]->order != found[tests - 1]->order) {
+	    found[tests++] = found[n];
+	}
+    }
+    for (n = 0; n < tests; n++) {
+	int nch = 0;
+
+	menu_test_loop(found[n]->test, state, &nch);
 	if (*state & MENU_STOP) {
 	    break;
 	}
@@ -389,12 +514,15 @@ menu_search(
 	    break;
 	}
     }
+    free(found);
+    return tests;
 }
 
 /*
 **	test_byname(menu, state, ch)
 **
-**	Get a cap name then run all tests that use that cap.
+**	Get a list of cap names then run all tests in this menu that use any
+**	of them.
 */
 static void
 test_byname(
@@ -403,15 +531,20 @@ test_byname(
 	       int *ch)
 {
     int test_state = 0;
-    char cap[32];
+    char names[TEMP_SIZE];
+    int caps[MAX_BYNAME];
 
     if (tty_can_sync == SYNC_NOT_TESTED) {
 	verify_time();
     }
-    ptext("enter name: ");
-    read_string(cap, sizeof(cap));
-    if (cap[0]) {
-	menu_search(menu, &test_state, ch, cap);
+    ptext("enter name(s): ");
+    read_string(names, sizeof(names));
+    if (names[0]) {
+	cap_ordinals(names, caps, MAX_BYNAME);
+	if (menu_test_caps(menu, caps, &test_state, ch) == 0) {
+	    sprintf(temp, "No tests use: %.*s", TEMP_SIZE - 20, names);
+	    ptextln(temp);
+	}
     }
     *ch = '?';
 }
@@ -0,0 +1,674 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+
+#include <tack.h>
+
+MODULE_ID("$Id: model.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * A model of what the screen should look like, used as the reference image
+ * when verifying the pad and crum tests.
+ *
+ * The output functions do not update the model as they go, since that would
+ * slow down the timing loops.  Instead, each cap sent with tt_tputs(),
+ * tt_putparm() or tc_putp(), and each character sent outside of a cap (e.g.,
+ * by put_this()), is appended to a short log.  Repeats of the same character
+ * or cap are counted rather than logged again.  The log is applied to the
+ * grid of cells when it fills up, or when the grid is needed.
+ *
+ * The log holds pointers, which are applied later, so only the terminal's
+ * own caps are logged as such.  Any other string, e.g., the result of
+ * tparm() or a request built in a buffer, marks the model as lost when it is
+ * logged.  Requests which do not change the screen are sent with the model
+ * suspended.
+ *
+ * Caps which the model does not know are assumed to leave the screen alone,
+ * unless they consist only of the control characters it does know.  Caps
+ * whose effect on the screen cannot be predicted (e.g., the alternate screen
+ * or video attributes, which change the checksum) mark the model as lost,
+ * until the next time the screen is cleared.
+ */
+
+#define MODEL_OPS	1024
+
+typedef struct {
+    const char *cap;		/* cap string, or null for a character */
+    int arg1;			/* first parameter, or the character */
+    int arg2;			/* second parameter */
+    int count;			/* number of repeats */
+} ModelOp;
+
+int model_active;		/* TRUE if output is being modeled */
+
+static ModelOp model_log[MODEL_OPS];
+static int model_used;
+
+static char *model_cells;	/* lines * columns, zero for an erased cell */
+static int model_lines;
+static int model_columns;
+static int model_lost;		/* TRUE if the screen contents are unknown */
+
+static int cur_row;		/* the cursor */
+static int cur_col;
+static int cur_wrap;		/* TRUE if the next character wraps (xenl) */
+static int saved_row;		/* position saved by (sc) */
+static int saved_col;
+static int margin_top;		/* the scroll region */
+static int margin_bottom;
+static int wrap_mode;		/* TRUE if (am) is in effect */
+static int insert_on;		/* TRUE if in insert mode */
+
+static const char model_unknown[] = "?";	/* marks unknown output */
+
+#define CELL(row, col)	model_cells[((row) * model_columns) + (col)]
+
+/*
+**	model_start()
+**
+**	Begin modeling the output.  The screen contents are unknown until
+**	the next time it is cleared.
+*/
+void
+model_start(void)
+{
+    model_active = TRUE;
+    model_used = 0;
+    model_lost = TRUE;
+    cur_row = cur_col = cur_wrap = 0;
+    saved_row = saved_col = 0;
+    margin_top = 0;
+    margin_bottom = lines - 1;
+    wrap_mode = auto_right_margin;
+    insert_on = FALSE;
+}
+
+/*
+**	model_forget()
+**
+**	Note that the output from here on changes the screen in a way which
+**	the model does not follow, e.g., using colors.  The screen is not
+**	checked until it is next cleared.
+*/
+void
+model_forget(void)
+{
+    if (model_active) {
+	model_cap(model_unknown, 0, 0);
+    }
+}
+
+/*
+**	model_suspend()
+**
+**	Stop modeling the output, e.g., while sending a request which does
+**	not change the screen.  Return the state for model_resume().
+*/
+int
+model_suspend(void)
+{
+    int active = model_active;
+
+    model_active = FALSE;
+    return active;
+}
+
+/*
+**	model_resume(active)
+**
+**	Restore the state saved by model_suspend().
+*/
+void
+model_resume(int active)
+{
+    model_active = active;
+}
+
+/*
+**	model_char(ch)
+**
+**	Log a character sent outside of a cap.
+*/
+void
+model_char(int ch)
+{
+    if (model_used > 0) {
+	ModelOp *op = &model_log[model_used - 1];
+
+	if (op->cap == NULL && op->arg1 == ch) {
+	    op->count++;
+	    return;
+	}
+    }
+    if (model_used >= MODEL_OPS) {
+	model_update();
+    }
+    model_log[model_used].cap = NULL;
+    model_log[model_used].arg1 = ch;
+    model_log[model_used].arg2 = 0;
+    model_log[model_used].count = 1;
+    model_used++;
+}
+
+/*
+**	model_cap(cap, arg1, arg2)
+**
+**	Log a cap sent to the terminal, with its parameters.  A string
+**	which is not one of the terminal's caps is logged as unknown, since
+**	it may be gone or rewritten by the time the log is applied.
+*/
+void
+model_cap(
+	     const char *cap,
+	     int arg1,
+	     int arg2)
+{
+    if (!VALID_STRING(cap)) {
+	return;
+    }
+    if (cap != model_unknown && get_string_cap_byvalue(cap) < 0) {
+	cap = model_unknown;
+	arg1 = arg2 = 0;
+    }
+    if (model_used > 0) {
+	ModelOp *op = &model_log[model_used - 1];
+
+	if (op->cap == cap && op->arg1 == arg1 && op->arg2 == arg2) {
+	    op->count++;
+	    return;
+	}
+    }
+    if (model_used >= MODEL_OPS) {
+	model_update();
+    }
+    model_log[model_used].cap = cap;
+    model_log[model_used].arg1 = arg1;
+    model_log[model_used].arg2 = arg2;
+    model_log[model_used].count = 1;
+    model_used++;
+}
+
+/*
+**	clip(value, low, high)
+**
+**	Limit a value to a range.
+*/
+static int
+clip(int value, int low, int high)
+{
+    if (value < low) {
+	value = low;
+    } else if (value > high) {
+	value = high;
+    }
+    return value;
+}
+
+/*
+**	erase_cells(row, first, last)
+**
+**	Erase the cells of a row from first to last, inclusive.
+*/
+static void
+erase_cells(int row, int first, int last)
+{
+    first = clip(first, 0, model_columns);
+    last = clip(last, -1, model_columns - 1);
+    if (first <= last) {
+	memset(&CELL(row, first), 0, (size_t) (last - first + 1));
+    }
+}
+
+/*
+**	scroll_up(top, bottom, n)
+**
+**	Scroll the rows from top to bottom up n rows, erasing at the bottom.
+*/
+static void
+scroll_up(int top, int bottom, int n)
+{
+    int row;
+
+    n = clip(n, 0, bottom - top + 1);
+    for (row = top; row <= bottom; row++) {
+	if (row + n <= bottom) {
+	    memcpy(&CELL(row, 0), &CELL(row + n, 0), (size_t) model_columns);
+	} else {
+	    erase_cells(row, 0, model_columns - 1);
+	}
+    }
+}
+
+/*
+**	scroll_down(top, bottom, n)
+**
+**	Scroll the rows from top to bottom down n rows, erasing at the top.
+*/
+static void
+scroll_down(int top, int bottom, int n)
+{
+    int row;
+
+    n = clip(n, 0, bottom - top + 1);
+    for (row = bottom; row >= top; row--) {
+	if (row - n >= top) {
+	    memcpy(&CELL(row, 0), &CELL(row - n, 0), (size_t) model_columns);
+	} else {
+	    erase_cells(row, 0, model_columns - 1);
+	}
+    }
+}
+
+/*
+**	insert_cells(n)
+**
+**	Insert n blanks at the cursor, shifting the rest of the row right.
+*/
+static void
+insert_cells(int n)
+{
+    int width = model_columns - cur_col;
+
+    n = clip(n, 0, width);
+    memmove(&CELL(cur_row, cur_col + n), &CELL(cur_row, cur_col),
+	    (size_t) (width - n));
+    erase_cells(cur_row, cur_col, cur_col + n - 1);
+}
+
+/*
+**	delete_cells(n)
+**
+**	Delete n cells at the cursor, shifting the rest of the row left.
+*/
+static void
+delete_cells(int n)
+{
+    int width = model_columns - cur_col;
+
+    n = clip(n, 0, width);
+    memmove(&CELL(cur_row, cur_col), &CELL(cur_row, cur_col + n),
+	    (size_t) (width - n));
+    erase_cells(cur_row, model_columns - n, model_columns - 1);
+}
+
+/*
+**	line_feed()
+**
+**	Move the cursor down, scrolling if it is at the bottom margin.
+*/
+static void
+line_feed(void)
+{
+    if (cur_row == margin_bottom) {
+	scroll_up(margin_top, margin_bottom, 1);
+    } else if (cur_row < model_lines - 1) {
+	cur_row++;
+    }
+}
+
+/*
+**	reverse_feed()
+**
+**	Move the cursor up, scrolling if it is at the top margin.
+*/
+static void
+reverse_feed(void)
+{
+    if (cur_row == margin_top) {
+	scroll_down(margin_top, margin_bottom, 1);
+    } else if (cur_row > 0) {
+	cur_row--;
+    }
+}
+
+/*
+**	move_rows(n)
+**
+**	Move the cursor up or down without scrolling.  The cursor stops at
+**	the margin if it starts inside the scroll region.
+*/
+static void
+move_rows(int n)
+{
+    int top = (cur_row >= margin_top) ? margin_top : 0;
+    int bottom = (cur_row <= margin_bottom) ? margin_bottom : model_lines - 1;
+
+    cur_row = clip(cur_row + n, top, bottom);
+}
+
+/*
+**	clear_all()
+**
+**	Erase the whole screen.  Its contents are known from here on.
+*/
+static void
+clear_all(void)
+{
+    memset(model_cells, 0, (size_t) (model_lines * model_columns));
+    model_lost = FALSE;
+}
+
+/*
+**	apply_char(ch)
+**
+**	Update the grid for a character sent to the terminal.
+*/
+static void
+apply_char(int ch)
+{
+    switch (ch) {
+    case '\r':
+	cur_col = 0;
+	break;
+    case '\n':
+	line_feed();
+	break;
+    case '\b':
+	if (cur_col > 0) {
+	    cur_col--;
+	}
+	break;
+    case '\t':
+	cur_col = clip(((cur_col / 8) + 1) * 8, 0, model_columns - 1);
+	break;
+    case 7:
+	return;
+    default:
+	if (ch < ' ' || ch >= 127) {
+	    model_lost = TRUE;
+	    break;
+	}
+	if (cur_wrap) {
+	    cur_col = 0;
+	    line_feed();
+	    cur_wrap = FALSE;
+	}
+	if (insert_on) {
+	    insert_cells(1);
+	}
+	CELL(cur_row, cur_col) = (char) ch;
+	if (cur_col < model_columns - 1) {
+	    cur_col++;
+	} else if (wrap_mode) {
+	    if (eat_newline_glitch) {
+		cur_wrap = TRUE;
+	    } else {
+		cur_col = 0;
+		line_feed();
+	    }
+	}
+	return;
+    }
+    cur_wrap = FALSE;
+}
+
+/*
+**	simple_cap(cap)
+**
+**	Return TRUE if the cap consists only of the control characters
+**	which apply_char() knows, ignoring padding.
+*/
+static int
+simple_cap(const char *cap)
+{
+    while (*cap != '\0') {
+	if (cap[0] == '$' && cap[1] == '<' && strchr(cap, '>') != NULL) {
+	    cap = strchr(cap, '>') + 1;
+	} else if (strchr("\r\n\b\t\007", *cap) != NULL) {
+	    cap++;
+	} else {
+	    return FALSE;
+	}
+    }
+    return TRUE;
+}
+
+/*
+**	apply_simple(cap)
+**
+**	Update the grid for each control character in the cap.
+*/
+static void
+apply_simple(const char *cap)
+{
+    while (*cap != '\0') {
+	if (*cap == '$') {
+	    cap = strchr(cap, '>') + 1;
+	} else {
+	    apply_char(UChar(*cap++));
+	}
+    }
+}
+
+/*
+**	unknown_cap(cap)
+**
+**	Return TRUE if the effect of the cap on the screen cannot be
+**	predicted.
+*/
+static int
+unknown_cap(const char *cap)
+{
+    return (cap == enter_ca_mode
+	    || cap == exit_ca_mode
+	    || cap == form_feed
+	    || cap == up_half_line
+	    || cap == down_half_line
+	    || cap == init_1string
+	    || cap == init_2string
+	    || cap == init_3string
+	    || cap == reset_1string
+	    || cap == reset_2string
+	    || cap == reset_3string
+	    || cap == enter_alt_charset_mode
+	    || cap == enter_blink_mode
+	    || cap == enter_bold_mode
+	    || cap == enter_dim_mode
+	    || cap == enter_protected_mode
+	    || cap == enter_reverse_mode
+	    || cap == enter_secure_mode
+	    || cap == enter_standout_mode
+	    || cap == enter_underline_mode
+	    || cap == set_attributes
+	    || cap == set_a_foreground
+	    || cap == set_a_background
+	    || cap == set_foreground
+	    || cap == set_background);
+}
+
+/*
+**	apply_cap(cap, arg1, arg2)
+**
+**	Update the grid for one cap sent to the terminal.
+*/
+static void
+apply_cap(
+	     const char *cap,
+	     int arg1,
+	     int arg2)
+{
+    int n;
+
+    cur_wrap = FALSE;
+    if (cap == clear_screen) {
+	clear_all();
+	cur_row = cur_col = 0;
+    } else if (cap == clr_eos) {
+	if (cur_row == 0 && cur_col == 0) {
+	    clear_all();
+	} else {
+	    erase_cells(cur_row, cur_col, model_columns - 1);
+	    for (n = cur_row + 1; n < model_lines; n++) {
+		erase_cells(n, 0, model_columns - 1);
+	    }
+	}
+    } else if (cap == clr_eol) {
+	erase_cells(cur_row, cur_col, model_columns - 1);
+    } else if (cap == clr_bol) {
+	erase_cells(cur_row, 0, cur_col);
+    } else if (cap == cursor_home) {
+	cur_row = cur_col = 0;
+    } else if (cap == cursor_to_ll) {
+	cur_row = model_lines - 1;
+	cur_col = 0;
+    } else if (cap == cursor_address) {
+	cur_row = clip(arg1, 0, model_lines - 1);
+	cur_col = clip(arg2, 0, model_columns - 1);
+    } else if (cap == row_address) {
+	cur_row = clip(arg1, 0, model_lines - 1);
+    } else if (cap == column_address) {
+	cur_col = clip(arg1, 0, model_columns - 1);
+    } else if (cap == carriage_return) {
+	cur_col = 0;
+    } else if (cap == newline) {
+	cur_col = 0;
+	line_feed();
+    } else if (cap == scroll_forward) {
+	line_feed();
+    } else if (cap == scroll_reverse) {
+	reverse_feed();
+    } else if (cap == cursor_down && !simple_cap(cap)) {
+	move_rows(1);
+    } else if (cap == cursor_up) {
+	move_rows(-1);
+    } else if (cap == parm_down_cursor) {
+	move_rows(arg1);
+    } else if (cap == parm_up_cursor) {
+	move_rows(-arg1);
+    } else if (cap == cursor_left && !simple_cap(cap)) {
+	cur_col = clip(cur_col - 1, 0, model_columns - 1);
+    } else if (cap == parm_left_cursor) {
+	cur_col = clip(cur_col - arg1, 0, model_columns - 1);
+    } else if (cap == cursor_right) {
+	cur_col = clip(cur_col + 1, 0, model_columns - 1);
+    } else if (cap == parm_right_cursor) {
+	cur_col = clip(cur_col + arg1, 0, model_columns - 1);
+    } else if (cap == change_scroll_region) {
+	margin_top = clip(arg1, 0, model_lines - 1);
+	margin_bottom = clip(arg2, margin_top, model_lines - 1);
+	cur_row = cur_col = 0;
+    } else if (cap == save_cursor) {
+	saved_row = cur_row;
+	saved_col = cur_col;
+    } else if (cap == restore_cursor) {
+	cur_row = saved_row;
+	cur_col = saved_col;
+    } else if (cap == insert_line || cap == parm_insert_line) {
+	if (cur_row >= margin_top && cur_row <= margin_bottom) {
+	    scroll_down(cur_row, margin_bottom,
+			(cap == insert_line) ? 1 : arg1);
+	    cur_col = 0;
+	}
+    } else if (cap == delete_line || cap == parm_delete_line) {
+	if (cur_row >= margin_top && cur_row <= margin_bottom) {
+	    scroll_up(cur_row, margin_bottom,
+		      (cap == delete_line) ? 1 : arg1);
+	    cur_col = 0;
+	}
+    } else if (cap == parm_index) {
+	scroll_up(margin_top, margin_bottom, arg1);
+    } else if (cap == parm_rindex) {
+	scroll_down(margin_top, margin_bottom, arg1);
+    } else if (cap == enter_insert_mode) {
+	insert_on = TRUE;
+    } else if (cap == exit_insert_mode) {
+	insert_on = FALSE;
+    } else if (cap == insert_character) {
+	if (!insert_on) {
+	    insert_cells(1);
+	}
+    } else if (cap == parm_ich) {
+	insert_cells(arg1);
+    } else if (cap == delete_character) {
+	delete_cells(1);
+    } else if (cap == parm_dch) {
+	delete_cells(arg1);
+    } else if (cap == erase_chars) {
+	erase_cells(cur_row, cur_col, cur_col + arg1 - 1);
+    } else if (cap == repeat_char) {
+	for (n = 0; n < arg2; n++) {
+	    apply_char(arg1);
+	}
+    } else if (cap == enter_am_mode) {
+	wrap_mode = TRUE;
+    } else if (cap == exit_am_mode) {
+	wrap_mode = FALSE;
+    } else if (cap == model_unknown || unknown_cap(cap)) {
+	model_lost = TRUE;
+    } else if (simple_cap(cap)) {
+	apply_simple(cap);
+    }
+}
+
+/*
+**	model_update()
+**
+**	Apply the logged output to the grid, and empty the log.
+*/
+void
+model_update(void)
+{
+    int n, k;
+
+    if (model_cells == NULL
+	|| model_lines != lines
+	|| model_columns != columns) {
+	/* the grid is small, and is only reallocated if the size changes */
+	model_lines = lines;
+	model_columns = columns;
+	model_cells = (char *) arena_alloc(&session_arena,
+					   (size_t) (lines * columns));
+	model_lost = TRUE;
+	cur_row = clip(cur_row, 0, lines - 1);
+	cur_col = clip(cur_col, 0, columns - 1);
+	margin_top = 0;
+	margin_bottom = lines - 1;
+    }
+    for (n = 0; n < model_used; n++) {
+	const ModelOp *op = &model_log[n];
+
+	for (k = 0; k < op->count; k++) {
+	    if (op->cap == NULL) {
+		apply_char(op->arg1);
+	    } else {
+		apply_cap(op->cap, op->arg1, op->arg2);
+	    }
+	}
+    }
+    model_used = 0;
+}
+
+/*
+**	model_verify(test_list)
+**
+**	Compare the screen with the model, if its contents are known.
+*/
+int
+model_verify(TestList * t)
+{
+    if (!model_active) {
+	return VERIFY_UNKNOWN;
+    }
+    model_update();
+    if (model_lost) {
+	return VERIFY_UNKNOWN;
+    }
+    return verify_screen(t, cur_row, cur_col, model_cells);
+}
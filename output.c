@@ -37,6 +37,8 @@ int raw_characters_sent;	/* Total output characters */
 /* local */
 static int log_column;		/* Number of characters on a log line */
 static int in_logging;		/* Filter debug logging for clarity */
+static int output_pending;	/* characters written since last flush */
+static unsigned long tputs_writes;	/* CNT_WRITE_USEC when tputs() began */
 
 /* translate mode default strings */
 #define TM_carriage_return	TM_string[0].value
@@ -84,35 +86,46 @@ getnext(int mask)
     unsigned char buf;
 
     if (debug_fp) {
-	fprintf(debug_fp, "getnext:\n");
+	trace_event(TR_GETNEXT, 0L, NULL);
+	trace_flush();
     }
     tc_putp(req_for_input);
-    fflush(stdout);
+    flush_output();
     if (nodelay_read) {
 	while (1) {
 	    ch = (int) read(fileno(stdin), &buf, sizeof(buf));
+	    COUNT_EVENT(CNT_READ_CALLS);
 	    if (ch == -1) {
 		if (debug_fp) {
-		    fprintf(debug_fp, "...getnext: EOF (nodelay)\n");
+		    trace_event(TR_GETNEXT_EOF_NODELAY, 0L, NULL);
 		}
 		return EOF;
 	    } else if (ch == 1) {
+		COUNT_EVENT(CNT_READ_BYTES);
+		if (record_fp) {
+		    record_char(RECORD_READ, buf);
+		}
 		if (debug_fp) {
-		    fprintf(debug_fp, "...getnext: 0x%02X (nodelay)\n", ch);
+		    trace_event(TR_GETNEXT_CHR_NODELAY, (long) buf, NULL);
 		}
 		return buf;
 	    }
 	}
     }
     ch = getchar();
+    COUNT_EVENT(CNT_READ_CALLS);
     if (ch != EOF) {
+	COUNT_EVENT(CNT_READ_BYTES);
+	if (record_fp) {
+	    record_char(RECORD_READ, ch);
+	}
 	ch &= mask;
 	if (debug_fp) {
-	    fprintf(debug_fp, "...getnext: 0x%02X\n", ch);
+	    trace_event(TR_GETNEXT_CHR, (long) ch, NULL);
 	}
     } else {
 	if (debug_fp) {
-	    fprintf(debug_fp, "...getnext: EOF\n");
+	    trace_event(TR_GETNEXT_EOF, 0L, NULL);
 	}
     }
     return ch;
@@ -123,7 +136,7 @@ getchp(int mask)
 {				/* read a character with scan mode conversion */
     if (scan_mode) {
 	tc_putp(req_for_input);
-	fflush(stdout);
+	flush_output();
 	return scan_key();
     } else
 	return getnext(mask);
@@ -164,6 +177,55 @@ log_str(FILE *fp, const char *value)
     }
 }
 
+/*
+**	flush_output()
+**
+**	Flush the standard output, counting the flushes and the writes.
+*/
+void
+flush_output(void)
+{
+    COUNT_EVENT(CNT_FLUSHES);
+    if (output_pending) {
+	COUNT_EVENT(CNT_WRITE_CALLS);
+	output_pending = 0;
+	event_start(TIME_WRITE);
+	fflush(stdout);
+	COUNT_ADD(CNT_WRITE_USEC, event_time(TIME_WRITE));
+    } else {
+	fflush(stdout);
+    }
+}
+
+/*
+**	tputs_start()
+**
+**	Start timing a call to tputs().
+*/
+static void
+tputs_start(void)
+{
+    tputs_writes = counter_value[CNT_WRITE_USEC];
+    event_start(TIME_TPUTS);
+}
+
+/*
+**	tputs_done()
+**
+**	Count the time spent in tputs(), less the time which tc_putch() spent
+**	writing, since that is counted in CNT_WRITE_USEC.
+*/
+static void
+tputs_done(void)
+{
+    unsigned long used = (unsigned long) event_time(TIME_TPUTS);
+    unsigned long wrote = counter_value[CNT_WRITE_USEC] - tputs_writes;
+
+    if (used > wrote) {
+	COUNT_ADD(CNT_TPUTS_USEC, used - wrote);
+    }
+}
+
 /*
 **	tc_putch(c)
 **
@@ -174,16 +236,54 @@ tc_putch(TC_PUTCH c)
 {
     char_sent++;
     raw_characters_sent++;
+    output_pending++;
+    COUNT_EVENT(CNT_WRITE_BYTES);
     putchar(c);
     if ((raw_characters_sent & 31) == 31) {
-	fflush(stdout);
+	flush_output();
     }
     if (log_fp) {
 	log_column = log_chr(log_fp, UChar(c), log_column);
     }
+    if (record_fp) {
+	record_char(RECORD_WRITE, UChar(c));
+    }
+    if (model_active && in_logging == 0) {
+	/* a character sent outside of a cap, e.g., by put_this() */
+	model_char(UChar(c));
+    }
     return (c);
 }
 
+/*
+**	tt_record(string, reps)
+**
+**	Count a cap sent inside a timing test, and the padding it asks for.
+*/
+static void
+tt_record(const char *string, int reps)
+{
+    int i;
+
+    for (i = 0; i < TT_MAX; i++) {
+	if (i >= ttp) {
+	    tt_cap[i] = string;
+	    tt_affected[i] = reps;
+	    tt_count[i] = 1;
+	    tt_delay[i] = msec_cost(string, reps);
+	    COUNT_ADD(CNT_PAD_REQUESTED, tt_delay[i]);
+	    ttp++;
+	    break;
+	}
+	if (string == tt_cap[i] && reps == tt_affected[i]) {
+	    tt_count[i]++;
+	    tt_delay_used += tt_delay[i];
+	    COUNT_ADD(CNT_PAD_REQUESTED, tt_delay[i]);
+	    break;
+	}
+    }
+}
+
 /*
 **	tt_tputs(string, reps)
 **
@@ -195,29 +295,16 @@ tt_tputs(const char *string, int reps)
 {
     ++in_logging;
     if (debug_fp && (in_logging == 1)) {
-	fprintf(debug_fp, "tt_tputs: string=");
-	log_str(debug_fp, string);
-	fprintf(debug_fp, ", reps=%d\n", reps);
+	trace_event(TR_TT_TPUTS, (long) reps, string);
     }
     if (string) {
-	int i;
-
-	for (i = 0; i < TT_MAX; i++) {
-	    if (i >= ttp) {
-		tt_cap[i] = string;
-		tt_affected[i] = reps;
-		tt_count[i] = 1;
-		tt_delay[i] = msec_cost(string, reps);
-		ttp++;
-		break;
-	    }
-	    if (string == tt_cap[i] && reps == tt_affected[i]) {
-		tt_count[i]++;
-		tt_delay_used += tt_delay[i];
-		break;
-	    }
-	}
+	tt_record(string, reps);
+	tputs_start();
 	(void) tputs(string, reps, tc_putch);
+	tputs_done();
+	if (model_active) {
+	    model_cap(string, 0, 0);
+	}
     }
     --in_logging;
 }
@@ -233,9 +320,7 @@ tt_putp(const char *string)
 {
     ++in_logging;
     if (debug_fp && (in_logging == 1)) {
-	fprintf(debug_fp, "tt_putp: string=");
-	log_str(debug_fp, string);
-	fprintf(debug_fp, "\n");
+	trace_event(TR_TT_PUTP, 0L, string);
     }
     tt_tputs(string, 1);
     --in_logging;
@@ -255,32 +340,52 @@ tt_putparm(
 	      int arg2)
 {
     if (string) {
-	int i;
+	char *value;
 
 	++in_logging;
 	if (debug_fp && (in_logging == 1)) {
-	    fprintf(debug_fp, "tc_putparm: string=");
-	    log_str(debug_fp, string);
-	    fprintf(debug_fp, ", reps=%d\n", reps);
-	}
-	for (i = 0; i < TT_MAX; i++) {
-	    if (i >= ttp) {
-		tt_cap[i] = string;
-		tt_affected[i] = reps;
-		tt_count[i] = 1;
-		tt_delay[i] = msec_cost(string, reps);
-		ttp++;
-		break;
-	    }
-	    if (string == tt_cap[i] && reps == tt_affected[i]) {
-		tt_count[i]++;
-		tt_delay_used += tt_delay[i];
-		break;
-	    }
+	    trace_event(TR_TT_PUTPARM, (long) reps, string);
+	}
+	tt_record(string, reps);
+	event_start(TIME_TPUTS);
+	value = TPARM_2((NCURSES_CONST char *) string, arg1, arg2);
+	COUNT_ADD(CNT_TPARM_USEC, event_time(TIME_TPUTS));
+	tputs_start();
+	(void) tputs(value, reps, tc_putch);
+	tputs_done();
+	if (model_active) {
+	    model_cap(string, arg1, arg2);
+	}
+	--in_logging;
+    }
+}
+
+/*
+**	tt_putvalue(string, value, reps)
+**
+**	Send tt_tputs(value, reps), where the value was expanded from the
+**	string with tparm(), and count it as the string.  This is for caps
+**	with more parameters than tt_putparm() passes.
+**	Use this function inside timing tests.
+*/
+void
+tt_putvalue(
+	       const char *string,
+	       const char *value,
+	       int reps)
+{
+    if (string && value) {
+	++in_logging;
+	if (debug_fp && (in_logging == 1)) {
+	    trace_event(TR_TT_PUTPARM, (long) reps, string);
+	}
+	tt_record(string, reps);
+	tputs_start();
+	(void) tputs(value, reps, tc_putch);
+	tputs_done();
+	if (model_active) {
+	    model_cap(string, 0, 0);
 	}
-	(void) tputs(TPARM_2((NCURSES_CONST char *) string, arg1, arg2),
-		     reps,
-		     tc_putch);
 	--in_logging;
     }
 }
@@ -298,11 +403,14 @@ tc_putp(const char *string)
     int rc = -1;
     if (VALID_STRING(string)) {
 	++in_logging;
+	tputs_start();
 	rc = tputs(string, 1, tc_putch);
+	tputs_done();
+	if (model_active) {
+	    model_cap(string, 0, 0);
+	}
 	if (debug_fp && (in_logging == 1)) {
-	    fprintf(debug_fp, "tc_putp: string=");
-	    log_str(debug_fp, string);
-	    fprintf(debug_fp, ", rc=%d\n", rc);
+	    trace_event(TR_TC_PUTP, (long) rc, string);
 	}
 	--in_logging;
     }
@@ -312,6 +420,9 @@ tc_putp(const char *string)
 void
 put_this(int c)
 {				/* output one character (with padding) */
+    if (sgr_coalesce) {
+	sgr_flush();
+    }
     tc_putch((TC_PUTCH) c);
     if (char_padding && replace_mode)
 	tt_putp(char_padding);
@@ -715,7 +826,7 @@ put_clear(void)
     int i;
 
     if (debug_fp) {
-	fprintf(debug_fp, "put_clear:\n");
+	trace_event(TR_PUT_CLEAR, 0L, NULL);
     }
     if (clear_screen)
 	tt_tputs(clear_screen, lines);
@@ -749,14 +860,14 @@ put_clear(void)
     } else {
 	can_clear_screen = FALSE;
 	if (debug_fp) {
-	    fprintf(debug_fp, "...put_clear: ERR\n");
+	    trace_event(TR_PUT_CLEAR_ERR, 0L, NULL);
 	}
 	return;
     }
     char_count = line_count = 0;
     can_clear_screen = TRUE;
     if (debug_fp) {
-	fprintf(debug_fp, "...put_clear: OK\n");
+	trace_event(TR_PUT_CLEAR_OK, 0L, NULL);
     }
 }
 
@@ -774,6 +885,12 @@ wait_here(void)
     char message[16];
     int i, j;
 
+    if (batch_mode) {
+	/* take the default action */
+	put_crlf();
+	char_sent = 0;
+	return '\r';
+    }
     for (i = 0; i < (int) sizeof(cc); i++) {
 	int ch = getchp(STRIP_PARITY);
 	if (ch == EOF)
@@ -117,6 +117,21 @@ init_xon_xoff(
     }
 }
 
+/*
+**	init_results(test_list, status, ch)
+**
+**	Discard the results of earlier runs, at the start of a run of the
+**	standard pad tests.
+*/
+static void
+init_results(
+		TestList * t GCC_UNUSED,
+		int *state GCC_UNUSED,
+		int *ch GCC_UNUSED)
+{
+    pad_results_reset();
+}
+
 /*
 **	pad_rmxon(test_list, status, ch)
 **
@@ -1877,6 +1892,229 @@ pad_crash(
     pad_test_shutdown(t, 1);
     pad_done_message(t, state, ch);
 }
+
+/*
+   The mode-switch churn test cycles each pair of mode strings with a
+   short line of text after every switch.  A run with the text alone
+   gives the cost of the text, which is taken off the cost of each pair.
+*/
+#define CHURN_BASE	0	/* the text alone */
+#define CHURN_CA	1	/* (smcup) (rmcup) with a blank main screen */
+#define CHURN_CA_FULL	2	/* (smcup) (rmcup) with a full main screen */
+#define CHURN_CIVIS	3	/* (civis) (cnorm) */
+#define CHURN_SMKX	4	/* (smkx) (rmkx) */
+#define CHURN_REPAINT	5	/* writing the whole screen, for comparison */
+#define CHURN_last	6
+
+static const struct {
+    const char *on;
+    const char *off;
+    const char *name;
+} churn_runs[CHURN_last] = {
+    {NULL, NULL, "text only"},
+    {"smcup", "rmcup", "(smcup) (rmcup)"},
+    {"smcup", "rmcup", "(smcup) (rmcup), full screen"},
+    {"civis", "cnorm", "(civis) (cnorm)"},
+    {"smkx", "rmkx", "(smkx) (rmkx)"},
+    {NULL, NULL, "full screen repaint"}
+};
+
+/*
+**	churn_text(count)
+**
+**	Write the short line of text which follows each mode switch.
+*/
+static void
+churn_text(int count)
+{
+    char tbuf[40];
+
+    put_cr();
+    sprintf(tbuf, "mode switch %06d %c", count, letter);
+    put_str(tbuf);
+}
+
+/*
+**	churn_fill()
+**
+**	Fill the screen with text, and leave the cursor at the top.
+*/
+static void
+churn_fill(void)
+{
+    int row, col;
+
+    go_home();
+    for (row = 0; row < lines - 1; row++) {
+	for (col = 0; col < columns - 1; col++) {
+	    putchp(letter);
+	}
+	put_crlf();
+    }
+    go_home();
+}
+
+/*
+**	churn_run(test_list, on, off, run)
+**
+**	Send the pair of mode strings over and over, with the text after
+**	each one, until the test time runs out.  Return the number of
+**	cycles.
+*/
+static int
+churn_run(
+	     TestList * t,
+	     const char *on,
+	     const char *off,
+	     int run)
+{
+    int cycles = 0;
+
+    if (run == CHURN_CA_FULL) {
+	/* put something on the main screen for (rmcup) to bring back */
+	put_clear();
+	churn_fill();
+	pad_test_startup(0);
+    } else {
+	pad_test_startup(1);
+    }
+    /* the model cannot follow the switch between screens */
+    model_forget();
+    do {
+	if (run == CHURN_REPAINT) {
+	    churn_fill();
+	} else {
+	    tt_putp(on);
+	    churn_text(cycles);
+	    tt_putp(off);
+	    churn_text(cycles);
+	}
+	cycles++;
+	if ((cycles % 100) == 0) {
+	    NEXT_LETTER;
+	}
+	SLOW_TERMINAL_EXIT;
+    } while (still_testing());
+    pad_test_shutdown(t, 0);
+    if (run == CHURN_CA_FULL) {
+	put_clear();
+    }
+    return cycles;
+}
+
+/*
+**	pad_churn(test_list, status, ch)
+**
+**	(smcup) (rmcup) (civis) (cnorm) (smkx) (rmkx) time the switches
+**	which full screen programs make over and over, and check whether
+**	(rmcup) costs more when there is text on the main screen.
+*/
+static void
+pad_churn(
+	     TestList * t,
+	     int *state,
+	     int *ch)
+{
+    const char *long_name;
+    const char *on[CHURN_last];
+    const char *off[CHURN_last];
+    int cycles[CHURN_last];
+    unsigned long usec[CHURN_last];
+    long cost[CHURN_last];	/* tenths of a microsecond per switch */
+    long base, repaint;
+    int n, x;
+    int in_ca_mode = send_reset_init && enter_ca_mode && exit_ca_mode;
+
+    for (n = 0; n < CHURN_last; n++) {
+	on[n] = off[n] = NULL;
+	cycles[n] = 0;
+	usec[n] = 0;
+	cost[n] = -1;
+	if (churn_runs[n].on != NULL) {
+	    on[n] = get_string_cap_byname(churn_runs[n].on, &long_name);
+	    off[n] = get_string_cap_byname(churn_runs[n].off, &long_name);
+	    if (!VALID_STRING(on[n]) || !VALID_STRING(off[n])) {
+		on[n] = off[n] = NULL;
+	    }
+	}
+    }
+    if (!on[CHURN_CA] && !on[CHURN_CIVIS] && !on[CHURN_SMKX]) {
+	CAP_NOT_FOUND;
+	ptext("(smcup) (rmcup) (civis) (cnorm) (smkx) (rmkx) not present.  ");
+	pad_done_message(t, state, ch);
+	return;
+    }
+    if (skip_pad_test(t, state, ch,
+		      "(smcup) (rmcup) (civis) (cnorm) (smkx) (rmkx) Start mode switch test")) {
+	return;
+    }
+    /* tack runs in the alternate screen; start the test from the main one */
+    if (in_ca_mode) {
+	tc_putp(exit_ca_mode);
+    }
+    for (n = 0; n < CHURN_last; n++) {
+	if (churn_runs[n].on == NULL || on[n] != NULL) {
+	    cycles[n] = churn_run(t, on[n], off[n], n);
+	    usec[n] = usec_run_time;
+	}
+    }
+    if (in_ca_mode) {
+	tc_putp(enter_ca_mode);
+    }
+    put_clear();
+
+    /* the text alone is written twice in each cycle */
+    base = cycles[CHURN_BASE]
+	? (long) ((usec[CHURN_BASE] * 10) / (unsigned long) cycles[CHURN_BASE])
+	: 0;
+    repaint = cycles[CHURN_REPAINT]
+	? (long) (usec[CHURN_REPAINT] / (unsigned long) cycles[CHURN_REPAINT])
+	: 0;
+    ptextln("mode switch                     switches/sec  usec/switch");
+    for (n = CHURN_CA; n < CHURN_REPAINT; n++) {
+	if (cycles[n] == 0) {
+	    sprintf(temp, "%-30s  not present", churn_runs[n].name);
+	} else {
+	    cost[n] = ((long) ((usec[n] * 10) / (unsigned long) cycles[n])
+		       - base) / 2;
+	    if (cost[n] < 0) {
+		cost[n] = 0;
+	    }
+	    sprintf(temp, "%-30s  %12lu  %7ld.%ld",
+		    churn_runs[n].name,
+		    (unsigned long) sliding_scale(cycles[n] * 2, 1000000,
+						  usec[n] ? usec[n] : 1),
+		    cost[n] / 10, cost[n] % 10);
+	}
+	ptextln(temp);
+    }
+    sprintf(temp, "A full screen repaint takes %ld usec.", repaint);
+    ptextln(temp);
+    put_crlf();
+
+    if (cost[CHURN_CA_FULL] >= 0 && repaint > 0) {
+	/* both switches together, against writing the screen once */
+	if (cost[CHURN_CA_FULL] * 2 >= repaint * 10 / 2) {
+	    ptextln("*** (smcup) (rmcup) cost at least half a full screen repaint.");
+	}
+	if (cost[CHURN_CA_FULL] > cost[CHURN_CA] * 2
+	    && (cost[CHURN_CA_FULL] - cost[CHURN_CA]) * 4 >= repaint * 10) {
+	    ptextln("*** (rmcup) costs more with text on the main screen:");
+	    ptextln("*** the terminal repaints or copies the saved screen.");
+	}
+    }
+    for (n = CHURN_CA; n < CHURN_REPAINT; n++) {
+	if (on[n] != NULL && n != CHURN_CA_FULL) {
+	    if ((x = get_string_cap_byvalue(on[n])) >= 0) {
+		show_cap_results(x);
+	    }
+	    if ((x = get_string_cap_byvalue(off[n])) >= 0) {
+		show_cap_results(x);
+	    }
+	}
+    }
+    pad_done_message(t, state, ch);
+}
 /* *INDENT-OFF* */
 
 TestList pad_test_list[] = {
@@ -1901,6 +2139,7 @@ TestList pad_test_list[] = {
        We have no control over this.  The only thing we can do for
        certain is to test the pad times by checking for overruns.
     ***/
+    {MENU_NEXT | MENU_INIT, 0, NULL, NULL, NULL, init_results, NULL},
     {MENU_NEXT, 3, "rs1", NULL, NULL, pad_standard, NULL},
     {MENU_NEXT, 3, "rs2", NULL, NULL, pad_standard, NULL},
     {MENU_NEXT, 3, "rs3", NULL, NULL, pad_standard, NULL},
@@ -1975,6 +2214,8 @@ TestList pad_test_list[] = {
        Phase 9: Test crash-and-burn properties of unpadded (clear).
     */
     {0, 0, "clear", "xon", "k) run clear test with no padding", pad_crash, NULL},
+    {0, 0, "smcup) (rmcup) (civis) (cnorm) (smkx) (rmkx", NULL, "m) mode switch churn", pad_churn, NULL},
+    {0, 0, "el) (ech) (rep) (ich) (dch", "cup", "u) screen update strategies", redraw_strategies, NULL},
     {MENU_LAST, 0, NULL, NULL, NULL, NULL, NULL}
 };
 /* *INDENT-ON* */
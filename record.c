@@ -0,0 +1,281 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+#include <tack.h>
+
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+MODULE_ID("$Id: record.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Binary session recorder and replay.
+ *
+ * The recording is a header followed by a series of records:
+ *	1 byte		record type (RECORD_WRITE or RECORD_READ)
+ *	4 bytes		microseconds since the previous record (big-endian)
+ *	2 bytes		number of data bytes (big-endian)
+ *	n bytes		the data, exactly as written or read
+ * A run of bytes in the same direction is collected into one record until
+ * the direction changes, the buffer fills, or the stream pauses.
+ */
+
+#define RECORD_MAGIC	"TACKREC1"
+#define RECORD_BLOCK	1024	/* largest data length of a record */
+#define RECORD_PAUSE	1000	/* microseconds gap which starts a record */
+
+/* globals */
+FILE *record_fp;		/* binary session recording */
+
+/* local */
+static int record_type;		/* direction of pending data, or 0 */
+static size_t record_used;	/* number of bytes of pending data */
+static unsigned char record_data[RECORD_BLOCK];
+static unsigned long record_start;	/* when the pending data began */
+static unsigned long record_last;	/* time of the previous byte */
+static unsigned long record_prior;	/* time of the previous record */
+
+#if HAVE_GETTIMEOFDAY
+static struct timeval record_epoch;
+#else
+static time_t record_epoch;
+#endif
+
+/*
+**	record_clock()
+**
+**	Return the number of microseconds since the recording was started.
+*/
+static unsigned long
+record_clock(void)
+{
+#if HAVE_GETTIMEOFDAY
+    struct timeval current_time;
+
+    (void) gettimeofday(&current_time, (struct timezone *) 0);
+    return (unsigned long) (((current_time.tv_sec - record_epoch.tv_sec) * 1000000)
+			    + current_time.tv_usec - record_epoch.tv_usec);
+#else
+    return (unsigned long) (time((time_t *) 0) - record_epoch) * 1000000;
+#endif
+}
+
+/*
+**	put_number(fp, value, length)
+**
+**	Write a big-endian number of the given number of bytes.
+*/
+static void
+put_number(FILE *fp, unsigned long value, int length)
+{
+    while (length-- > 0) {
+	fputc((int) ((value >> (8 * length)) & 0xff), fp);
+    }
+}
+
+/*
+**	get_number(fp, length, result)
+**
+**	Read a big-endian number.  Return FALSE at end of file.
+*/
+static int
+get_number(FILE *fp, int length, unsigned long *result)
+{
+    *result = 0;
+    while (length-- > 0) {
+	int ch = fgetc(fp);
+
+	if (ch == EOF)
+	    return FALSE;
+	*result = (*result << 8) | (unsigned long) ch;
+    }
+    return TRUE;
+}
+
+/*
+**	record_flush()
+**
+**	Write the pending data (if any) as a record.
+*/
+void
+record_flush(void)
+{
+    if (record_fp && record_used) {
+	fputc(record_type, record_fp);
+	put_number(record_fp, record_start - record_prior, 4);
+	put_number(record_fp, (unsigned long) record_used, 2);
+	IGNORE_RC(fwrite(record_data, sizeof(char), record_used, record_fp));
+	record_prior = record_start;
+	record_used = 0;
+	record_type = 0;
+    }
+}
+
+/*
+**	record_char(type, ch)
+**
+**	Add one character written to, or read from, the terminal to the
+**	session recording.
+*/
+void
+record_char(int type, int ch)
+{
+    unsigned long now;
+
+    if (record_fp == NULL)
+	return;
+    now = record_clock();
+    if (type != record_type
+	|| record_used >= sizeof(record_data)
+	|| now - record_last > RECORD_PAUSE) {
+	record_flush();
+	record_type = type;
+	record_start = now;
+    }
+    record_data[record_used++] = UChar(ch);
+    record_last = now;
+}
+
+/*
+**	record_chars(type, buffer, length)
+**
+**	Add a block of characters to the session recording.
+*/
+void
+record_chars(int type, const char *buffer, size_t length)
+{
+    while (record_fp && length-- != 0) {
+	record_char(type, UChar(*buffer++));
+    }
+}
+
+/*
+**	record_open(filename)
+**
+**	Start a session recording.
+*/
+void
+record_open(const char *filename)
+{
+    if ((record_fp = fopen(filename, "wb")) == NULL) {
+	perror(filename);
+	ExitProgram(EXIT_FAILURE);
+    }
+#if HAVE_GETTIMEOFDAY
+    (void) gettimeofday(&record_epoch, (struct timezone *) 0);
+#else
+    record_epoch = time((time_t *) 0);
+#endif
+    record_used = 0;
+    record_type = 0;
+    record_last = record_prior = 0;
+    fputs(RECORD_MAGIC, record_fp);
+}
+
+/*
+**	record_close()
+**
+**	Write the last record and close the session recording.
+*/
+void
+record_close(void)
+{
+    if (record_fp) {
+	record_flush();
+	fclose(record_fp);
+	record_fp = NULL;
+    }
+}
+
+/*
+**	replay_session(filename, fast)
+**
+**	Play the characters written in a recorded session back to the
+**	terminal, either with the original pacing or as fast as possible.
+**	The characters read from the terminal are counted but not sent.
+*/
+void
+replay_session(const char *filename, int fast)
+{
+    FILE *fp;
+    char magic[sizeof(RECORD_MAGIC)];
+    unsigned char data[RECORD_BLOCK];
+    unsigned long delta, length;
+    unsigned long recorded = 0;
+    unsigned long written = 0;
+    unsigned long host_bytes = 0;
+    unsigned long records = 0;
+    unsigned long elapsed;
+    int type;
+
+    if ((fp = fopen(filename, "rb")) == NULL) {
+	perror(filename);
+	ExitProgram(EXIT_FAILURE);
+    }
+    if (fread(magic, sizeof(char), sizeof(magic) - 1, fp) != sizeof(magic) - 1
+	|| strncmp(magic, RECORD_MAGIC, sizeof(magic) - 1)) {
+	fprintf(stderr, "%s: not a tack session recording\n", filename);
+	fclose(fp);
+	ExitProgram(EXIT_FAILURE);
+    }
+    tty_init();
+    tty_raw(1, ALLOW_PARITY);
+    fflush(stdout);
+    event_start(TIME_TEST);
+    while ((type = fgetc(fp)) != EOF) {
+	if (!get_number(fp, 4, &delta)
+	    || !get_number(fp, 2, &length)
+	    || length > sizeof(data)
+	    || fread(data, sizeof(char), (size_t) length, fp) != length) {
+	    break;
+	}
+	recorded += delta;
+	records++;
+	if (type != RECORD_WRITE) {
+	    host_bytes += length;
+	    continue;
+	}
+	if (!fast) {
+	    long ahead = (long) recorded - event_time(TIME_TEST);
+
+	    if (ahead > 1000) {
+		fflush(stdout);
+		napms((int) (ahead / 1000));
+	    }
+	}
+	IGNORE_RC(fwrite(data, sizeof(char), (size_t) length, stdout));
+	written += length;
+    }
+    fflush(stdout);
+    elapsed = (unsigned long) event_time(TIME_TEST);
+    fclose(fp);
+    tty_reset();
+    fprintf(stderr, "\r\n%s: %lu records, %lu characters written, %lu read\r\n",
+	    filename, records, written, host_bytes);
+    fprintf(stderr, "recorded %lu.%03lu seconds, replayed in %lu.%03lu seconds",
+	    recorded / 1000000, (recorded % 1000000) / 1000,
+	    elapsed / 1000000, (elapsed % 1000000) / 1000);
+    if (elapsed) {
+	fprintf(stderr, " (%d characters per second)",
+		sliding_scale((int) written, 1000000, elapsed));
+    }
+    fprintf(stderr, "\r\n");
+}
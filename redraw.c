@@ -0,0 +1,395 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+#include <tack.h>
+
+MODULE_ID("$Id: redraw.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Compare ways of updating a damaged screen.
+ *
+ * The pad tests time (el) (ech) (rep) (ich) (dch) one at a time, which
+ * says how much padding they need, but not whether a program should use
+ * them rather than rewrite the text.  This test applies the same damage
+ * to every line of the screen in several ways, and times each:
+ *
+ *	rewrite the whole line,
+ *	rewrite only the characters which changed,
+ *	use the cap which matches the damage.
+ *
+ * Each pass damages the lines on even frames and repairs them on odd
+ * frames, so that the screen always returns to the same text.  The repair
+ * is written the same way by each method, except for the line rewrite.
+ * Clearing the screen and redrawing it is timed once, for comparison.
+ */
+
+#define REDRAW_SPAN	8	/* characters changed, erased or inserted */
+#define REDRAW_RUN	20	/* length of a run of one character */
+
+#define DAMAGE_CHANGE	0	/* characters replaced by others */
+#define DAMAGE_EL	1	/* the end of the line erased */
+#define DAMAGE_ECH	2	/* characters in the line erased */
+#define DAMAGE_REP	3	/* a run of one character */
+#define DAMAGE_SHIFT	4	/* characters inserted, then deleted */
+#define DAMAGE_last	5
+
+#define METHOD_LINE	0	/* rewrite the whole line */
+#define METHOD_TEXT	1	/* rewrite the characters which changed */
+#define METHOD_CAP	2	/* use (el) (ech) (rep) (ich) (dch) */
+#define METHOD_last	3
+
+static const char *damage_name[DAMAGE_last] =
+{
+    "change characters",
+    "erase to end of line",
+    "erase characters",
+    "run of one character",
+    "insert/delete chars"
+};
+
+static const char *method_name[METHOD_last] =
+{
+    "whole line",
+    "changed text",
+    NULL			/* the cap name */
+};
+
+static int redraw_width;	/* columns used on each line */
+static int redraw_length;	/* length of the undamaged text */
+static int redraw_rows;		/* lines damaged in each frame */
+
+/*
+**	damage_cap(damage)
+**
+**	Return the name of the cap which repairs the damage directly, or
+**	null if there is none, or the terminal does not have it.
+*/
+static const char *
+damage_cap(int damage)
+{
+    switch (damage) {
+    case DAMAGE_EL:
+	return clr_eol ? "(el)" : NULL;
+    case DAMAGE_ECH:
+	return erase_chars ? "(ech)" : NULL;
+    case DAMAGE_REP:
+	return repeat_char ? "(rep)" : NULL;
+    case DAMAGE_SHIFT:
+	return (parm_ich && parm_dch) ? "(ich) (dch)" : NULL;
+    }
+    return NULL;
+}
+
+/*
+**	redraw_line(damage, row, pass, damaged, line)
+**
+**	Fill the line with the text for the row, damaged if asked.  The
+**	position of the damage depends on the row and the pass, so that it
+**	moves about.  Return the position.
+*/
+static int
+redraw_line(
+	       int damage,
+	       int row,
+	       int pass,
+	       int damaged,
+	       char *line)
+{
+    int col;
+    int at = 2 + ((pass * 5) + (row * 3)) % (redraw_length / 2);
+    int ch = 'A' + ((pass + row) % 26);
+
+    for (col = 0; col < redraw_width; col++) {
+	line[col] = (char) ((col < redraw_length)
+			    ? ('a' + ((col + row) % 26))
+			    : ' ');
+    }
+    line[redraw_width] = '\0';
+    if (damaged) {
+	switch (damage) {
+	case DAMAGE_CHANGE:
+	    memset(line + at, ch, (size_t) REDRAW_SPAN);
+	    break;
+	case DAMAGE_EL:
+	    memset(line + at, ' ', (size_t) (redraw_width - at));
+	    break;
+	case DAMAGE_ECH:
+	    memset(line + at, ' ', (size_t) REDRAW_SPAN);
+	    break;
+	case DAMAGE_REP:
+	    memset(line + at, ch, (size_t) REDRAW_RUN);
+	    break;
+	case DAMAGE_SHIFT:
+	    memmove(line + at + REDRAW_SPAN, line + at,
+		    (size_t) (redraw_width - at - REDRAW_SPAN));
+	    memset(line + at, ch, (size_t) REDRAW_SPAN);
+	    break;
+	}
+    }
+    return at;
+}
+
+/*
+**	redraw_text(row, before, after)
+**
+**	Rewrite the characters which differ between the two lines.
+*/
+static void
+redraw_text(
+	       int row,
+	       const char *before,
+	       const char *after)
+{
+    int first, last;
+
+    for (first = 0; first < redraw_width; first++) {
+	if (before[first] != after[first])
+	    break;
+    }
+    if (first < redraw_width) {
+	for (last = redraw_width - 1; last > first; last--) {
+	    if (before[last] != after[last])
+		break;
+	}
+	tt_putparm(cursor_address, 1, row, first);
+	while (first <= last) {
+	    put_this(UChar(after[first++]));
+	}
+    }
+}
+
+/*
+**	redraw_cap(damage, row, at, after)
+**
+**	Damage the line with the cap which matches the damage.
+*/
+static void
+redraw_cap(
+	      int damage,
+	      int row,
+	      int at,
+	      const char *after)
+{
+    int n;
+
+    tt_putparm(cursor_address, 1, row, at);
+    switch (damage) {
+    case DAMAGE_EL:
+	tt_putp(clr_eol);
+	break;
+    case DAMAGE_ECH:
+	tt_putparm(erase_chars, REDRAW_SPAN, REDRAW_SPAN, 0);
+	break;
+    case DAMAGE_REP:
+	tt_putparm(repeat_char, REDRAW_RUN, UChar(after[at]), REDRAW_RUN);
+	break;
+    case DAMAGE_SHIFT:
+	tt_putparm(parm_ich, REDRAW_SPAN, REDRAW_SPAN, 0);
+	for (n = 0; n < REDRAW_SPAN; n++) {
+	    put_this(UChar(after[at + n]));
+	}
+	break;
+    }
+}
+
+/*
+**	redraw_screen()
+**
+**	Draw the undamaged text on the screen.
+*/
+static void
+redraw_screen(void)
+{
+    char line[TEMP_SIZE];
+    int row;
+
+    put_clear();
+    for (row = 0; row < redraw_rows; row++) {
+	redraw_line(DAMAGE_CHANGE, row, 0, FALSE, line);
+	tt_putparm(cursor_address, 1, row, 0);
+	put_str(line);
+    }
+}
+
+/*
+**	redraw_run(test_list, damage, method)
+**
+**	Damage and repair every line with the method until the test time
+**	runs out.  A negative method clears and redraws the whole screen
+**	for each frame.  Return the number of frames.
+*/
+static int
+redraw_run(
+	      TestList * t,
+	      int damage,
+	      int method)
+{
+    char before[TEMP_SIZE];
+    char after[TEMP_SIZE];
+    int frames = 0;
+
+    redraw_screen();
+    pad_test_startup(0);
+    /* the model does not follow (ech) (rep) (ich) (dch) */
+    model_forget();
+    do {
+	int pass = frames / 2;
+	int damaged = !(frames & 1);
+	int row;
+
+	if (method < 0) {
+	    tt_putp(clear_screen);
+	}
+	for (row = 0; row < redraw_rows; row++) {
+	    int at = redraw_line(damage, row, pass, !damaged, before);
+
+	    (void) redraw_line(damage, row, pass, damaged, after);
+	    if (method < 0 || method == METHOD_LINE) {
+		tt_putparm(cursor_address, 1, row, 0);
+		put_str(after);
+	    } else if (method == METHOD_TEXT) {
+		redraw_text(row, before, after);
+	    } else if (damaged) {
+		redraw_cap(damage, row, at, after);
+	    } else if (damage == DAMAGE_SHIFT) {
+		tt_putparm(cursor_address, 1, row, at);
+		tt_putparm(parm_dch, REDRAW_SPAN, REDRAW_SPAN, 0);
+	    } else {
+		redraw_text(row, before, after);
+	    }
+	}
+	frames++;
+	SLOW_TERMINAL_EXIT;
+    } while (still_testing());
+    pad_test_shutdown(t, 0);
+    return frames;
+}
+
+/*
+**	redraw_cost(usec, frames)
+**
+**	Return the cost of updating one line, in tenths of a microsecond.
+*/
+static long
+redraw_cost(
+	       unsigned long usec,
+	       int frames)
+{
+    unsigned long lines_done = (unsigned long) frames * (unsigned long) redraw_rows;
+
+    return lines_done ? (long) ((usec * 10) / lines_done) : -1;
+}
+
+/*
+**	redraw_strategies(test_list, status, ch)
+**
+**	Time each way of repairing each kind of damage, and recommend the
+**	cheapest one for this terminal.
+*/
+void
+redraw_strategies(
+		     TestList * t,
+		     int *state,
+		     int *ch)
+{
+    long cost[DAMAGE_last][METHOD_last];
+    long full = -1;
+    int damage, method, frames;
+    char value[METHOD_last][20];
+
+    if (!cursor_address) {
+	ptext("(cup) Cursor-address is needed to compare screen updates.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+    if (skip_pad_test(t, state, ch,
+		      "(el) (ech) (rep) (ich) (dch) Start screen update comparison")) {
+	return;
+    }
+    redraw_width = columns - 1;
+    if (redraw_width >= TEMP_SIZE) {
+	redraw_width = TEMP_SIZE - 1;
+    }
+    redraw_length = (redraw_width * 3) / 4;
+    redraw_rows = lines - 1;
+    if (redraw_width - redraw_length < REDRAW_SPAN
+	|| 2 + (redraw_length / 2) + REDRAW_RUN > redraw_length) {
+	ptext("The screen is too narrow to compare screen updates.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+
+    for (damage = 0; damage < DAMAGE_last; damage++) {
+	for (method = 0; method < METHOD_last; method++) {
+	    cost[damage][method] = -1;
+	    if (method == METHOD_CAP && damage_cap(damage) == NULL) {
+		continue;
+	    }
+	    /* usec_run_time is set by the run */
+	    frames = redraw_run(t, damage, method);
+	    cost[damage][method] = redraw_cost(usec_run_time, frames);
+	}
+    }
+    if (clear_screen) {
+	frames = redraw_run(t, DAMAGE_CHANGE, -1);
+	full = redraw_cost(usec_run_time, frames);
+    }
+
+    put_clear();
+    ptextln("usec per line:");
+    sprintf(temp, "%-22s %10s %10s %10s  best",
+	    "damage", "line", "changed", "cap");
+    ptextln(temp);
+    for (damage = 0; damage < DAMAGE_last; damage++) {
+	const char *cap = damage_cap(damage);
+	int best = -1;
+
+	for (method = 0; method < METHOD_last; method++) {
+	    long c = cost[damage][method];
+
+	    if (c < 0) {
+		strcpy(value[method], "-");
+	    } else {
+		sprintf(value[method], "%ld.%ld", c / 10, c % 10);
+		if (best < 0 || c < cost[damage][best]) {
+		    best = method;
+		}
+	    }
+	}
+	sprintf(temp, "%-22s %10s %10s %10s  %s",
+		damage_name[damage],
+		value[METHOD_LINE],
+		value[METHOD_TEXT],
+		value[METHOD_CAP],
+		(best < 0)
+		? "-"
+		: ((best == METHOD_CAP) ? cap : method_name[best]));
+	ptextln(temp);
+    }
+    if (full >= 0) {
+	sprintf(temp, "Clearing and redrawing the screen costs %ld.%ld usec per line.",
+		full / 10, full % 10);
+	ptextln(temp);
+    }
+    sprintf(temp, "Each line is %d characters; %d are changed, or %d for a run.",
+	    redraw_width, REDRAW_SPAN, REDRAW_RUN);
+    ptextln(temp);
+    pad_done_message(t, state, ch);
+}
@@ -0,0 +1,427 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+#include <tack.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/wait.h>
+
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+#if HAVE_SYS_SELECT_H
+#include <sys/select.h>
+#endif
+
+MODULE_ID("$Id: runner.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Run the pad tests for several terminal types in parallel.
+ *
+ * Each worker is a copy of tack running in batch mode (-b) on its own
+ * pseudo-terminal.  Its report is written to a pipe connected to the
+ * standard error.  Nothing is connected to the other end of the pty,
+ * so the runner answers the ENQ/ACK and device-attribute requests which
+ * tack uses for synchronization, and discards the rest of the output.
+ */
+
+#define IDLE_POKE	5	/* seconds before sending a return */
+#define IDLE_KILL	60	/* seconds before giving up on a worker */
+#define EXEC_FAILED	127	/* exit-status when the program cannot run */
+
+typedef struct {
+    const char *term;		/* terminal name to test */
+    pid_t pid;			/* process-id, or 0 if not running */
+    int master;			/* pty master, or -1 */
+    int report;			/* read-end of report pipe, or -1 */
+    int status;			/* exit-status */
+    int started;		/* TRUE if the worker was forked */
+    int done;			/* TRUE when the worker has finished */
+    char *text;			/* report text */
+    size_t used;
+    size_t size;
+    unsigned long output;	/* characters written to the pty */
+    char recent[8];		/* tail of the pty output, for replies */
+    long begun;			/* milliseconds since the run began */
+    long finished;
+    long idle;			/* time of the last activity, or poke */
+    long last_output;		/* time of the last output on the pty */
+} Worker;
+
+static Worker *workers;
+static int num_workers;
+
+#if HAVE_GETTIMEOFDAY
+static struct timeval run_epoch;
+#else
+static time_t run_epoch;
+#endif
+
+/*
+**	run_clock()
+**
+**	Return the number of milliseconds since the run began.
+*/
+static long
+run_clock(void)
+{
+#if HAVE_GETTIMEOFDAY
+    struct timeval current_time;
+
+    (void) gettimeofday(&current_time, (struct timezone *) 0);
+    return ((current_time.tv_sec - run_epoch.tv_sec) * 1000)
+	+ (current_time.tv_usec - run_epoch.tv_usec) / 1000;
+#else
+    return (long) (time((time_t *) 0) - run_epoch) * 1000;
+#endif
+}
+
+/*
+**	add_report(w, buffer, length)
+**
+**	Append text to the worker's report.
+*/
+static void
+add_report(Worker * w, const char *buffer, size_t length)
+{
+    if (w->used + length + 1 > w->size) {
+	w->size = (w->used + length + 1) * 2;
+	w->text = realloc(w->text, w->size);
+	if (w->text == NULL) {
+	    fprintf(stderr, "tack: out of memory\n");
+	    ExitProgram(EXIT_FAILURE);
+	}
+    }
+    memcpy(w->text + w->used, buffer, length);
+    w->used += length;
+    w->text[w->used] = '\0';
+}
+
+/*
+**	answer_worker(w, buffer, length)
+**
+**	Watch the worker's output for requests which expect a reply from the
+**	terminal, and answer them as a VT100 would.
+*/
+static void
+answer_worker(Worker * w, const char *buffer, size_t length)
+{
+    static const struct {
+	const char *request;
+	const char *reply;
+    } replies[] = {
+	{"\005", "\006"},
+	{"\033[c", "\033[?1;2c"},
+	{"\033[0c", "\033[?1;2c"},
+	{"\033[>c", "\033[>0;10;1c"},
+	{"\033[>0c", "\033[>0;10;1c"},
+	{"\033[6n", "\033[1;1R"}
+    };
+    size_t n, k;
+
+    for (n = 0; n < length; ++n) {
+	memmove(w->recent, w->recent + 1, sizeof(w->recent) - 2);
+	w->recent[sizeof(w->recent) - 2] = buffer[n];
+	w->recent[sizeof(w->recent) - 1] = '\0';
+	for (k = 0; k < sizeof(replies) / sizeof(replies[0]); ++k) {
+	    size_t want = strlen(replies[k].request);
+	    const char *tail = w->recent + sizeof(w->recent) - 1 - want;
+
+	    if (!memcmp(tail, replies[k].request, want)) {
+		IGNORE_RC(write(w->master, replies[k].reply, strlen(replies[k].reply)));
+		break;
+	    }
+	}
+    }
+}
+
+/*
+**	start_worker(program, options, w)
+**
+**	Open a pty and start a copy of tack in batch mode on it, with the
+**	options given to this copy.  The descriptors which the runner keeps
+**	are closed on exec, so that the later workers do not hold them open.
+*/
+static int
+start_worker(const char *program, const char *options, Worker * w)
+{
+    int pipes[2];
+    int slave;
+
+    if (!tty_open_pty(&w->master, &slave)) {
+	w->master = -1;
+	sprintf(temp, "cannot open a pty: %s\n", strerror(errno));
+	add_report(w, temp, strlen(temp));
+	return FALSE;
+    }
+    if (pipe(pipes) != 0) {
+	sprintf(temp, "cannot open a pipe: %s\n", strerror(errno));
+	add_report(w, temp, strlen(temp));
+	close(slave);
+	return FALSE;
+    }
+    (void) fcntl(w->master, F_SETFD, FD_CLOEXEC);
+    (void) fcntl(pipes[0], F_SETFD, FD_CLOEXEC);
+    fflush(stdout);
+    fflush(stderr);
+    if ((w->pid = fork()) < 0) {
+	sprintf(temp, "cannot fork: %s\n", strerror(errno));
+	add_report(w, temp, strlen(temp));
+	close(pipes[0]);
+	close(pipes[1]);
+	close(slave);
+	return FALSE;
+    }
+    if (w->pid == 0) {
+	setsid();
+#ifdef TIOCSCTTY
+	(void) ioctl(slave, TIOCSCTTY, 0);
+#endif
+	dup2(slave, 0);
+	dup2(slave, 1);
+	dup2(pipes[1], 2);
+	close(slave);
+	close(pipes[0]);
+	close(pipes[1]);
+	close(w->master);
+	execlp(program, program, options, w->term, (char *) 0);
+	fprintf(stderr, "cannot execute %s: %s\n", program, strerror(errno));
+	_exit(EXEC_FAILED);
+    }
+    close(pipes[1]);
+    close(slave);
+    w->report = pipes[0];
+    w->started = TRUE;
+    w->begun = w->idle = w->last_output = run_clock();
+    return TRUE;
+}
+
+/*
+**	finish_worker(w)
+**
+**	Collect the exit-status of a worker and close its descriptors.
+*/
+static void
+finish_worker(Worker * w)
+{
+    if (w->master >= 0) {
+	close(w->master);
+	w->master = -1;
+    }
+    if (w->report >= 0) {
+	close(w->report);
+	w->report = -1;
+    }
+    if (w->pid > 0) {
+	if (waitpid(w->pid, &(w->status), 0) < 0) {
+	    w->started = FALSE;
+	}
+	w->pid = 0;
+    }
+    w->finished = run_clock();
+    w->done = TRUE;
+}
+
+/*
+**	poll_workers()
+**
+**	Wait for output from any of the running workers, and handle it.
+**	Return the number of workers still running.
+*/
+static int
+poll_workers(void)
+{
+    fd_set ifds;
+    struct timeval tv;
+    int n, top = -1, running = 0;
+    char buffer[BUFSIZ];
+
+    FD_ZERO(&ifds);
+    for (n = 0; n < num_workers; ++n) {
+	Worker *w = &workers[n];
+
+	if (w->done || w->pid <= 0)
+	    continue;
+	++running;
+	if (w->master >= 0) {
+	    FD_SET(w->master, &ifds);
+	    if (w->master > top)
+		top = w->master;
+	}
+	if (w->report >= 0) {
+	    FD_SET(w->report, &ifds);
+	    if (w->report > top)
+		top = w->report;
+	}
+    }
+    if (running == 0)
+	return 0;
+    tv.tv_sec = 1;
+    tv.tv_usec = 0;
+    if (select(top + 1, &ifds, NULL, NULL, &tv) < 0)
+	return running;
+    for (n = 0; n < num_workers; ++n) {
+	Worker *w = &workers[n];
+	int got;
+
+	if (w->done || w->pid <= 0)
+	    continue;
+	if (w->master >= 0 && FD_ISSET(w->master, &ifds)) {
+	    if ((got = (int) read(w->master, buffer, sizeof(buffer))) > 0) {
+		w->output += (unsigned long) got;
+		w->idle = w->last_output = run_clock();
+		answer_worker(w, buffer, (size_t) got);
+	    } else {
+		close(w->master);
+		w->master = -1;
+	    }
+	}
+	if (w->report >= 0 && FD_ISSET(w->report, &ifds)) {
+	    if ((got = (int) read(w->report, buffer, sizeof(buffer))) > 0) {
+		add_report(w, buffer, (size_t) got);
+	    } else {
+		/* the worker has exited, or closed its standard error */
+		finish_worker(w);
+		--running;
+		continue;
+	    }
+	}
+	/* the poke below does not count as activity here */
+	if (run_clock() - w->last_output > IDLE_KILL * 1000) {
+	    sprintf(temp, "*** no output for %d seconds, stopped\n", IDLE_KILL);
+	    add_report(w, temp, strlen(temp));
+	    kill(w->pid, SIGKILL);
+	    finish_worker(w);
+	    --running;
+	} else if (w->master >= 0
+		   && run_clock() - w->idle > IDLE_POKE * 1000) {
+	    /* unblock a read which the runner did not know how to answer */
+	    IGNORE_RC(write(w->master, "\r", (size_t) 1));
+	    w->idle = run_clock();
+	}
+    }
+    return running;
+}
+
+/*
+**	worker_status(w)
+**
+**	Describe how the worker ended.
+*/
+static const char *
+worker_status(Worker * w)
+{
+    static char result[40];
+
+    if (!w->started) {
+	strcpy(result, "not started");
+    } else if (WIFSIGNALED(w->status)) {
+	sprintf(result, "signal %d", WTERMSIG(w->status));
+    } else if (!WIFEXITED(w->status)) {
+	strcpy(result, "unknown status");
+    } else if (WEXITSTATUS(w->status) == EXEC_FAILED) {
+	strcpy(result, "cannot execute");
+    } else {
+	sprintf(result, "exit %d", WEXITSTATUS(w->status));
+    }
+    return result;
+}
+
+/*
+**	run_matrix(program, options, terms, count, jobs)
+**
+**	Run the pad tests in batch mode for each terminal name, with up to
+**	the given number of workers at a time, and write a combined report.
+**	The options (e.g., "-bcv") are passed to each worker.
+*/
+void
+run_matrix(
+	      const char *program,
+	      const char *options,
+	      char **terms,
+	      int count,
+	      int jobs)
+{
+    int n, next, running;
+    long total = 0;
+
+    if (jobs <= 0) {
+#ifdef _SC_NPROCESSORS_ONLN
+	jobs = (int) sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+	if (jobs <= 0)
+	    jobs = 1;
+    }
+    workers = (Worker *) calloc((size_t) count, sizeof(Worker));
+    if (workers == NULL) {
+	fprintf(stderr, "tack: out of memory\n");
+	ExitProgram(EXIT_FAILURE);
+    }
+    num_workers = count;
+    for (n = 0; n < count; ++n) {
+	workers[n].term = terms[n];
+	workers[n].master = -1;
+	workers[n].report = -1;
+    }
+#if HAVE_GETTIMEOFDAY
+    (void) gettimeofday(&run_epoch, (struct timezone *) 0);
+#else
+    run_epoch = time((time_t *) 0);
+#endif
+    signal(SIGPIPE, SIG_IGN);
+
+    for (next = running = 0; next < count || running > 0;) {
+	while (next < count && running < jobs) {
+	    if (start_worker(program, options, &workers[next])) {
+		++running;
+	    } else {
+		workers[next].begun = run_clock();
+		finish_worker(&workers[next]);
+	    }
+	    ++next;
+	}
+	running = poll_workers();
+    }
+
+    for (n = 0; n < count; ++n) {
+	Worker *w = &workers[n];
+	long elapsed = w->finished - w->begun;
+
+	total += elapsed;
+	printf("==> %s: %ld.%03ld seconds, %lu characters, %s\n",
+	       w->term,
+	       elapsed / 1000, elapsed % 1000,
+	       w->output,
+	       worker_status(w));
+	if (w->text != NULL) {
+	    fputs(w->text, stdout);
+	    free(w->text);
+	}
+	printf("\n");
+    }
+    n = (int) run_clock();
+    printf("%d terminals, %d jobs: %d.%03d seconds (%ld.%03ld seconds if run in turn)\n",
+	   count, jobs,
+	   n / 1000, n % 1000,
+	   total / 1000, total % 1000);
+    free(workers);
+}
@@ -30,7 +30,6 @@ size_t *scan_tested, *scan_length;
 static unsigned *scan_value;
 
 static unsigned shift_state;
-static int debug_char_count;
 
 #define SHIFT_KEY   0x100
 #define CONTROL_KEY 0x200
@@ -48,15 +47,15 @@ scan_key(void)
 	int j;
 	int ch = getchar();
 
+	COUNT_EVENT(CNT_READ_CALLS);
 	if (ch == EOF)
 	    return EOF;
+	COUNT_EVENT(CNT_READ_BYTES);
+	if (record_fp) {
+	    record_char(RECORD_READ, ch);
+	}
 	if (debug_fp) {
-	    fprintf(debug_fp, "%02X ", ch);
-	    debug_char_count += 3;
-	    if (debug_char_count > 72) {
-		fprintf(debug_fp, "\n");
-		debug_char_count = 0;
-	    }
+	    trace_event(TR_SCAN_KEY, (long) ch, NULL);
 	}
 	buf[i - 1] = (char) ch;
 	buf[i] = '\0';
@@ -0,0 +1,306 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+
+#include <tack.h>
+
+MODULE_ID("$Id: sgr.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Attribute and color state tracker.
+ *
+ * When sgr_coalesce is set, set_attr() and new_color() pass their changes
+ * here rather than sending them.  The tracker remembers what the terminal
+ * was last told, drops a change which would not alter it, and holds the
+ * rest until the next character is written by put_this().
+ *
+ * The held changes are sent together.  If a change is a plain ECMA-48 SGR
+ * sequence (CSI parameters m) and the text held so far ends with another,
+ * the two are combined into one sequence, e.g., the bold from (sgr) with the
+ * colors from (setaf) and (setab).
+ *
+ * The tracker is not used when the terminal has magic cookies, since then
+ * every change takes up space on the screen.
+ */
+
+#define SGR_BUFFER	256	/* held changes */
+#define SGR_PARAMS	16	/* parameters allowed in a combined sequence */
+
+#define SGR_DEFAULT	(-1)	/* color state after a reset */
+#define SGR_UNKNOWN	(-2)	/* state which cannot be predicted */
+
+int sgr_coalesce;		/* TRUE to send changes through the tracker */
+int sgr_changes;		/* changes requested */
+int sgr_dropped;		/* changes which were redundant */
+int sgr_merged;			/* changes combined with an earlier one */
+
+static int cur_attr = SGR_UNKNOWN;
+static int cur_fg = SGR_UNKNOWN;
+static int cur_bg = SGR_UNKNOWN;
+
+static char sgr_buffer[SGR_BUFFER];
+static int sgr_used;		/* length of the held text */
+static int sgr_csi;		/* offset of a trailing CSI ... m, or -1 */
+
+/*
+**	sgr_params(s)
+**
+**	If the string is exactly one CSI ... m sequence, return the length of
+**	its parameters.  Otherwise return -1.
+*/
+static int
+sgr_params(const char *s)
+{
+    int n;
+
+    if (s[0] != '\033' || s[1] != '[') {
+	return -1;
+    }
+    for (n = 2; isdigit(UChar(s[n])) || s[n] == ';' || s[n] == ':'; n++) ;
+    return (s[n] == 'm' && s[n + 1] == '\0') ? n - 2 : -1;
+}
+
+/*
+**	sgr_trailing(s)
+**
+**	Return the offset of the CSI ... m sequence which ends the string,
+**	or -1 if it does not end with one.
+*/
+static int
+sgr_trailing(const char *s)
+{
+    const char *p;
+    const char *last = NULL;
+
+    for (p = s; (p = strchr(p, '\033')) != NULL; p++) {
+	if (p[1] == '[') {
+	    last = p;
+	}
+    }
+    return (last != NULL && sgr_params(last) >= 0) ? (int) (last - s) : -1;
+}
+
+/*
+**	sgr_resets(s)
+**
+**	Return TRUE if the string ends with an SGR sequence which begins by
+**	resetting the attributes (and with them the colors), FALSE if it ends
+**	with one which does not.  Return -1 if it is not an SGR sequence.
+*/
+static int
+sgr_resets(const char *s)
+{
+    int n = sgr_trailing(s);
+
+    if (n < 0) {
+	return -1;
+    }
+    for (s += n + 2; *s == '0'; s++) ;
+    return (*s == ';' || *s == 'm');
+}
+
+/*
+**	sgr_count(s)
+**
+**	Return the number of parameters in the SGR sequence at the string.
+*/
+static int
+sgr_count(const char *s)
+{
+    int result = 1;
+
+    for (s += 2; *s != 'm'; s++) {
+	if (*s == ';') {
+	    result++;
+	}
+    }
+    return result;
+}
+
+/*
+**	sgr_send()
+**
+**	Send the held text.
+*/
+static void
+sgr_send(void)
+{
+    if (sgr_used) {
+	tc_putp(sgr_buffer);
+    }
+    sgr_used = 0;
+    sgr_csi = -1;
+    sgr_buffer[0] = '\0';
+}
+
+/*
+**	sgr_append(s)
+**
+**	Add a change to the held text, combining it with a trailing SGR
+**	sequence if both are plain SGR sequences.
+*/
+static void
+sgr_append(const char *s)
+{
+    int params = sgr_params(s);
+    int len = (int) strlen(s);
+
+    if (params >= 0
+	&& sgr_csi >= 0
+	&& sgr_used + params + 3 < SGR_BUFFER
+	&& sgr_count(sgr_buffer + sgr_csi) + sgr_count(s) <= SGR_PARAMS) {
+	/* replace the final "m" with ";" and the new parameters */
+	char *d = sgr_buffer + sgr_used - 1;
+
+	if (sgr_used - sgr_csi == 3) {
+	    *d++ = '0';		/* an empty list means zero */
+	}
+	*d++ = ';';
+	if (params == 0) {
+	    *d++ = '0';
+	} else {
+	    memcpy(d, s + 2, (size_t) params);
+	    d += params;
+	}
+	*d++ = 'm';
+	*d = '\0';
+	sgr_used = (int) (d - sgr_buffer);
+	sgr_merged++;
+	return;
+    }
+    if (sgr_used + len >= SGR_BUFFER) {
+	sgr_send();
+    }
+    if (len >= SGR_BUFFER) {
+	tc_putp(s);
+	return;
+    }
+    strcpy(sgr_buffer + sgr_used, s);
+    sgr_csi = sgr_trailing(s);
+    if (sgr_csi >= 0) {
+	sgr_csi += sgr_used;
+    }
+    sgr_used += len;
+}
+
+/*
+**	sgr_start(flag)
+**
+**	Turn the tracker on or off.  The state of the terminal is not known
+**	when it starts.  The counts are kept after it stops.
+*/
+void
+sgr_start(int flag)
+{
+    sgr_forget();
+    sgr_coalesce = flag && magic_cookie_glitch <= 0;
+    if (sgr_coalesce) {
+	sgr_changes = sgr_dropped = sgr_merged = 0;
+    }
+}
+
+/*
+**	sgr_forget()
+**
+**	Send the held changes, and forget the state of the terminal, e.g.,
+**	after the colors are reset without the tracker.
+*/
+void
+sgr_forget(void)
+{
+    sgr_send();
+    cur_attr = cur_fg = cur_bg = SGR_UNKNOWN;
+}
+
+/*
+**	sgr_attr(a)
+**
+**	Change the attributes to the bits in a, as set_attr() does.
+*/
+void
+sgr_attr(int a)
+{
+    const char *s;
+    int resets;
+
+    sgr_changes++;
+    if (a == cur_attr) {
+	sgr_dropped++;
+	return;
+    }
+    if (a == 0 && exit_attribute_mode) {
+	s = TPARM_0(exit_attribute_mode);
+    } else if (a != 0 && set_attributes) {
+	s = TPARM_9(set_attributes,
+		    (a >> 1) & 1, (a >> 2) & 1, (a >> 3) & 1,
+		    (a >> 4) & 1, (a >> 5) & 1, (a >> 6) & 1,
+		    (a >> 7) & 1, (a >> 8) & 1, (a >> 9) & 1);
+    } else {
+	/* set_attr() sends nothing */
+	return;
+    }
+    if (!VALID_STRING(s)) {
+	cur_attr = cur_fg = cur_bg = SGR_UNKNOWN;
+	return;
+    }
+    sgr_append(s);
+    cur_attr = a;
+    if ((resets = sgr_resets(s)) < 0) {
+	cur_fg = cur_bg = SGR_UNKNOWN;
+    } else if (resets) {
+	cur_fg = cur_bg = SGR_DEFAULT;
+    }
+}
+
+/*
+**	sgr_color(fg, bg)
+**
+**	Change the colors with (setaf) and (setab), as new_color() does.
+*/
+void
+sgr_color(int fg, int bg)
+{
+    sgr_changes += 2;
+    if (fg == cur_fg) {
+	sgr_dropped++;
+    } else {
+	sgr_append(TPARM_1(set_a_foreground, fg));
+	cur_fg = fg;
+    }
+    if (bg == cur_bg) {
+	sgr_dropped++;
+    } else {
+	sgr_append(TPARM_1(set_a_background, bg));
+	cur_bg = bg;
+    }
+}
+
+/*
+**	sgr_flush()
+**
+**	Send the held changes before a character is written.
+*/
+void
+sgr_flush(void)
+{
+    if (sgr_used) {
+	sgr_send();
+    }
+}
@@ -75,9 +75,12 @@ tty_sync_error(void)
 
     trouble = FALSE;
     for (;;) {
-	int ch, ack;
+	int ch, ack, active;
 
+	COUNT_EVENT(CNT_SYNC_PROBES);
+	active = model_suspend();
 	tt_putp(tty_ENQ);	/* send ENQ */
+	model_resume(active);
 	ch = getnext(STRIP_PARITY);
 	event_start(TIME_SYNC);	/* start the timer */
 
@@ -105,6 +108,7 @@ tty_sync_error(void)
 	    }
 	}
 
+	COUNT_EVENT(CNT_SYNC_FAILS);
 	set_attr(0);		/* just in case */
 	put_crlf();
 	if (trouble) {
@@ -139,10 +143,10 @@ flush_input(void)
 static void
 probe_enq_ok(void)
 {
-    int len;
+    int len, active;
 
     put_str("Testing ENQ/ACK, standby...");
-    fflush(stdout);
+    flush_output();
     can_test("u8 u9", FLAG_TESTED);
 
 #ifdef user9
@@ -150,7 +154,9 @@ probe_enq_ok(void)
 #else
     tty_ENQ = "\005";
 #endif
+    active = model_suspend();
     tc_putp(tty_ENQ);
+    model_resume(active);
     event_start(TIME_SYNC);	/* start the timer */
     read_key(tty_ACK, (sizeof(tty_ACK) - 1));
 
@@ -217,7 +223,7 @@ probe_response(const char *command, const char *respond)
 {
     NCURSES_CONST char *command_cap = safe_tgets(command);
     NCURSES_CONST char *respond_cap = safe_tgets(respond);
-    int len;
+    int len, active;
     int code = 0;
 
     if (command_cap == NULL || respond_cap == NULL) {
@@ -227,10 +233,12 @@ probe_response(const char *command, const char *respond)
     } else {
 	sprintf(temp, "Testing %s/%s, standby...", command, respond);
 	put_str(temp);
-	fflush(stdout);
+	flush_output();
 	/* TODO: can_test("u8 u9", FLAG_TESTED); */
 
+	active = model_suspend();
 	tc_putp(command_cap);
+	model_resume(active);
 	event_start(TIME_SYNC);	/* start the timer */
 	read_key(tty_ACK, (sizeof(tty_ACK) - 1));
 
@@ -269,6 +277,45 @@ probe_response(const char *command, const char *respond)
     return code;
 }
 
+/*
+**	tty_identity(buffer, size)
+**
+**	Ask the terminal to identify itself with the ENQ (u9), secondary
+**	device attributes (RV) and version (XR) requests, and store the
+**	replies in the buffer separated by semicolons.
+*/
+void
+tty_identity(char *buf, size_t size)
+{
+    static NCURSES_CONST char *const requests[] =
+    {"u9", "RV", "XR"};
+    size_t n, used = 0;
+
+    *buf = '\0';
+    for (n = 0; n < sizeof(requests) / sizeof(requests[0]); n++) {
+	const char *request = ((n == 0 && tty_ENQ != NULL)
+			       ? tty_ENQ
+			       : safe_tgets(requests[n]));
+	char reply[sizeof(tty_ACK)];
+	size_t len;
+
+	reply[0] = '\0';
+	if (VALID_STRING(request)) {
+	    int active = model_suspend();
+
+	    tc_putp(request);
+	    model_resume(active);
+	    (void) read_reply(reply, sizeof(reply) - 1);
+	}
+	len = strlen(reply);
+	if (used + len + 2 > size) {
+	    break;
+	}
+	sprintf(buf + used, "%s%s", n ? ";" : "", reply);
+	used += strlen(buf + used);
+    }
+}
+
 /*
 **	verify_response()
 */
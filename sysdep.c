@@ -28,7 +28,9 @@
 
 #include <term.h>
 #include <errno.h>
+#include <fcntl.h>
 #include <regex.h>
+#include <sys/ioctl.h>
 
 #if defined(__BEOS__)
 #undef false
@@ -101,7 +103,7 @@ void
 tty_raw(int minch GCC_UNUSED, int mask)
 {				/* set tty to raw noecho */
     if (debug_fp) {
-	fprintf(debug_fp, "tty_raw:\n");
+	trace_event(TR_TTY_RAW, 0L, NULL);
     }
     new_modes = old_modes;
 #ifdef TERMIOS
@@ -140,13 +142,13 @@ tty_raw(int minch GCC_UNUSED, int mask)
 #endif
     if (not_a_tty) {
 	if (debug_fp) {
-	    fprintf(debug_fp, "...tty_raw: not a tty\n");
+	    trace_event(TR_TTY_RAW_NOTTY, 0L, NULL);
 	}
 	return;
     }
     PUT_TTY(fileno(stdin), &new_modes);
     if (debug_fp) {
-	fprintf(debug_fp, "...tty_raw: done\n");
+	trace_event(TR_TTY_RAW_DONE, 0L, NULL);
     }
 }
 
@@ -154,7 +156,7 @@ void
 tty_set(void)
 {				/* set tty to special modes */
     if (debug_fp) {
-	fprintf(debug_fp, "tty_set:\n");
+	trace_event(TR_TTY_SET, 0L, NULL);
     }
     new_modes = old_modes;
 #ifdef TERMIOS
@@ -204,14 +206,14 @@ tty_set(void)
     new_modes.sg_flags |= RAW;
     if (not_a_tty) {
 	if (debug_fp) {
-	    fprintf(debug_fp, "...tty_set: not a tty\n");
+	    trace_event(TR_TTY_SET_NOTTY, 0L, NULL);
 	}
 	return;
     }
 #endif
     PUT_TTY(fileno(stdin), &new_modes);
     if (debug_fp) {
-	fprintf(debug_fp, "...tty_set: done\n");
+	trace_event(TR_TTY_SET_DONE, 0L, NULL);
     }
 }
 
@@ -219,18 +221,18 @@ void
 tty_reset(void)
 {				/* reset the tty to the original modes */
     if (debug_fp) {
-	fprintf(debug_fp, "tty_reset:\n");
+	trace_event(TR_TTY_RESET, 0L, NULL);
     }
-    fflush(stdout);
+    flush_output();
     if (not_a_tty) {
 	if (debug_fp) {
-	    fprintf(debug_fp, "...tty_reset: not a tty\n");
+	    trace_event(TR_TTY_RESET_NOTTY, 0L, NULL);
 	}
 	return;
     }
     PUT_TTY(fileno(stdin), &old_modes);
     if (debug_fp) {
-	fprintf(debug_fp, "...tty_reset: done\n");
+	trace_event(TR_TTY_RESET_DONE, 0L, NULL);
     }
 }
 
@@ -396,13 +398,22 @@ char_ready(void)
 void
 spin_flush(void)
 {
-    unsigned char buf[64];
+    char buf[64];
 
-    fflush(stdout);
+    flush_output();
     event_start(TIME_FLUSH);	/* start the timer */
     do {
 	if (char_ready()) {
-	    if (read(fileno(stdin), &buf, sizeof(buf)) != 0)
+	    int got = (int) read(fileno(stdin), buf, sizeof(buf));
+
+	    COUNT_EVENT(CNT_READ_CALLS);
+	    if (got > 0) {
+		COUNT_ADD(CNT_READ_BYTES, got);
+	    }
+	    if (got > 0 && record_fp) {
+		record_chars(RECORD_READ, buf, (size_t) got);
+	    }
+	    if (got != 0)
 		break;
 	}
     } while (event_time(TIME_FLUSH) < 400000);
@@ -421,15 +432,17 @@ read_key(char *buf, size_t max)
     char *s;
 
     if (debug_fp) {
-	fprintf(debug_fp, "read_key: max=%lu\n", (unsigned long) max);
+	trace_event(TR_READ_KEY, (long) max, NULL);
+	trace_flush();
     }
     *buf = '\0';
     s = buf;
-    fflush(stdout);
+    flush_output();
     /* ATT unix may return 0 or 1, Berkeley Unix should be 1 */
     while (read(fileno(stdin), s, (size_t) 1) <= 0) {
-	;			/* EMPTY */
+	COUNT_EVENT(CNT_READ_CALLS);
     }
+    COUNT_EVENT(CNT_READ_CALLS);
     ++s;
     --max;
     while ((int) max > 0 && (ask = char_ready()) > 0) {
@@ -438,6 +451,7 @@ read_key(char *buf, size_t max)
 	if (ask > (int) max) {
 	    ask = (int) max;
 	}
+	COUNT_EVENT(CNT_READ_CALLS);
 	if ((got = (int) read(fileno(stdin), s, (size_t) ask)) > 0) {
 	    s += got;
 	} else {
@@ -447,6 +461,10 @@ read_key(char *buf, size_t max)
     }
     *s = '\0';
     l = (int) (s - buf);
+    COUNT_ADD(CNT_READ_BYTES, l);
+    if (record_fp) {
+	record_chars(RECORD_READ, buf, (size_t) l);
+    }
     for (s = buf, i = 0; i < l; i++) {
 	if ((*s & 0x7f) == 0) {
 	    /* convert nulls to 0x80 */
@@ -457,10 +475,142 @@ read_key(char *buf, size_t max)
 	}
     }
     if (debug_fp) {
-	fprintf(debug_fp, "...read_key: result=");
-	log_str(debug_fp, buf);
-	fprintf(debug_fp, "\n");
+	trace_event(TR_READ_KEY_RESULT, 0L, buf);
+    }
+}
+
+/*
+**	read_reply(buf, max)
+**
+**	Read the reply to a request sent to the terminal.  Unlike read_key(),
+**	return an empty string if nothing arrives within a short time.
+**	Return the length of the reply.
+*/
+int
+read_reply(char *buf, size_t max)
+{
+    *buf = '\0';
+    flush_output();
+    if (char_ready() > 0) {
+	read_key(buf, max);
     }
+    return (int) strlen(buf);
+}
+
+/*
+**	tty_read_input(fd, buf, max, usec)
+**
+**	Wait up to the given number of microseconds for input on a
+**	descriptor, and read what is there, without waiting for more.
+**	Return the number of characters read, or zero if none came.
+*/
+int
+tty_read_input(int fd, char *buf, size_t max, long usec)
+{
+    int got;
+#if HAVE_SELECT && defined(FD_ZERO)
+    fd_set ifds;
+    struct timeval tv;
+
+    FD_ZERO(&ifds);
+    FD_SET(fd, &ifds);
+    tv.tv_sec = usec / 1000000;
+    tv.tv_usec = usec % 1000000;
+    if (select(fd + 1, &ifds, NULL, NULL, &tv) <= 0) {
+	return 0;
+    }
+#else
+    (void) usec;
+#endif
+    got = (int) read(fd, buf, max);
+    COUNT_EVENT(CNT_READ_CALLS);
+    if (got <= 0) {
+	return 0;
+    }
+    COUNT_ADD(CNT_READ_BYTES, got);
+    if (record_fp && fd == fileno(stdin)) {
+	record_chars(RECORD_READ, buf, (size_t) got);
+    }
+    return got;
+}
+
+/*
+**	tty_queued()
+**
+**	Return the number of characters in the output queue of the tty, i.e.,
+**	written by tack but not yet sent to the terminal.  Return -1 if the
+**	system cannot tell.
+*/
+int
+tty_queued(void)
+{
+#ifdef TIOCOUTQ
+    int n;
+
+    if (!not_a_tty && ioctl(fileno(stdout), TIOCOUTQ, &n) == 0) {
+	return n;
+    }
+#endif
+    return -1;
+}
+
+/*
+**	tty_drain()
+**
+**	Flush the output, and wait until the tty has sent all of it.
+*/
+void
+tty_drain(void)
+{
+    flush_output();
+#ifdef TERMIOS
+    if (!not_a_tty) {
+	(void) tcdrain(fileno(stdout));
+    }
+#endif
+}
+
+/*
+**	tty_open_pty(master, slave)
+**
+**	Open a pseudo-terminal, with the slave in raw mode, so that what is
+**	written to the master arrives unchanged.  Return TRUE if successful.
+*/
+int
+tty_open_pty(int *master, int *slave)
+{
+#ifdef TERMIOS
+    TTY modes;
+    char *name;
+
+    *master = open("/dev/ptmx", O_RDWR | O_NOCTTY);
+    if (*master < 0) {
+	return FALSE;
+    }
+    if (grantpt(*master) != 0
+	|| unlockpt(*master) != 0
+	|| (name = ptsname(*master)) == NULL
+	|| (*slave = open(name, O_RDWR | O_NOCTTY)) < 0) {
+	close(*master);
+	return FALSE;
+    }
+    if (tcgetattr(*slave, &modes) == 0) {
+	modes.c_iflag &= (unsigned) ~(IGNBRK | BRKINT | PARMRK | ISTRIP
+				      | INLCR | IGNCR | ICRNL | IXON | IXOFF);
+	modes.c_oflag &= (unsigned) ~OPOST;
+	modes.c_lflag &= (unsigned) ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
+	modes.c_cflag &= (unsigned) ~(CSIZE | PARENB);
+	modes.c_cflag |= CS8;
+	modes.c_cc[VMIN] = 1;
+	modes.c_cc[VTIME] = 0;
+	(void) tcsetattr(*slave, TCSANOW, &modes);
+    }
+    return TRUE;
+#else
+    (void) master;
+    (void) slave;
+    return FALSE;
+#endif
 }
 
 void
@@ -487,6 +637,7 @@ onintr(int sig GCC_UNUSED)
 {
     ignoresig();
     tty_reset();
+    trace_close();
     ExitProgram(EXIT_FAILURE);
 }
 
@@ -574,8 +725,9 @@ compare_regex(const char *name, const char *terminfo, const char *actual)
      */
     if (terminfo == NULL || strlen(terminfo) >= (sizeof(pattern) / 2)) {
 	rc = -1;
-	if (debug_fp)
-	    fprintf(debug_fp, "ABSENT %s\n", terminfo);
+	if (debug_fp) {
+	    trace_event(TR_ABSENT, 0L, terminfo);
+	}
     } else {
 	int escape = 0;
 	int use_plus = 0;
@@ -630,7 +782,10 @@ compare_regex(const char *name, const char *terminfo, const char *actual)
 	sprintf(buffer, "Unexpected pattern (%s): %.30s", name, terminfo);
 	putln(expand(buffer));
 	if (debug_fp) {
-	    fprintf(debug_fp, "Bad regex(%s): %s\n", name, expand(buffer));
+	    char *value = expand(buffer);
+
+	    sprintf(buffer, "Bad regex(%s): %.1000s", name, value);
+	    trace_event(TR_MESSAGE, 0L, buffer);
 	}
 	return rc;
     }
@@ -639,8 +794,12 @@ compare_regex(const char *name, const char *terminfo, const char *actual)
      * Now we can use POSIX regex.
      */
     if (debug_fp) {
+	char *value;
+
 	sprintf(buffer, "%s", pattern);
-	fprintf(debug_fp, "Regex(%s): %s\n", name, expand(buffer));
+	value = expand(buffer);
+	sprintf(buffer, "Regex(%s): %.1000s", name, value);
+	trace_event(TR_MESSAGE, 0L, buffer);
     }
 #define NPARAM 10
     if ((code = regcomp(&regex, pattern, REG_EXTENDED)) == 0) {
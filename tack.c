@@ -57,6 +57,7 @@ int select_xon_xoff;		/* TTY driver XON/XOFF mode select */
 int hex_out;			/* Display output in hex */
 int send_reset_init;		/* Send the reset and initialization strings */
 FILE *log_fp;			/* Terminal logfile */
+int batch_mode;			/* run the pad tests without prompting */
 
 #if defined(__GNUC__) && defined(_FORTIFY_SOURCE)
 int ignore_unused;
@@ -90,6 +91,7 @@ static TestList tools_test_list[] =
     {0, 0, NULL, NULL, "2) test RV/rv secondary attributes (DA2)", ask_DA2, NULL},
     {0, 0, NULL, NULL, "v) test XR/xr version (XTVERSION)", ask_version, NULL},
     {0, 0, NULL, NULL, "d) change debug level", tools_debug, NULL},
+    {MENU_CLEAR, 0, NULL, NULL, "k) show instrumentation counters", show_counters, NULL},
     {MENU_LAST, 0, NULL, NULL, NULL, NULL, NULL}
     /* *INDENT-ON* */
 };
@@ -155,6 +157,14 @@ static TestMenu acs_menu =
     NULL, acs_test_list, NULL, 0, 0
 };
 
+static TestMenu utf8_menu =
+{
+    0, 'n', NULL,
+    "Test UTF-8 text:",
+    "utf8", "n) run standard tests",
+    NULL, utf8_test_list, NULL, 0, 0
+};
+
 static TestMenu color_menu =
 {
     0, 'n', NULL,
@@ -203,6 +213,7 @@ static TestList normal_test_list[] = {
     {MENU_NEXT, 0, NULL, NULL, "x) test modes and glitches", NULL, &mode_menu},
     {MENU_NEXT, 0, NULL, NULL, "a) test alternate character set and graphic rendition", NULL, &acs_menu},
     {MENU_NEXT, 0, NULL, NULL, "c) test color", NULL, &color_menu},
+    {0, 0, NULL, NULL, "u) test UTF-8 text", NULL, &utf8_menu},
     {MENU_NEXT, 0, NULL, NULL, "m) test cursor movement", NULL, &crum_menu},
     {MENU_NEXT, 0, NULL, NULL, "f) test function keys", NULL, &funkey_menu},
     {MENU_NEXT, 0, NULL, NULL, "p) test padding and string capabilities", NULL, &pad_menu},
@@ -452,6 +463,7 @@ pad_gen(
 	   int *ch)
 {
     control_init();
+    pad_results_reset();
     if (tty_can_sync == SYNC_NOT_TESTED) {
 	verify_time();
     }
@@ -546,6 +558,53 @@ start_log(
     }
 }
 
+/*
+**	retest_terminfo(name)
+**
+**	Run only the tests which use the caps that differ between the named
+**	terminal description and the one being tested.
+*/
+static void
+retest_terminfo(
+		   const char *name)
+{
+    int *caps = (int *) calloc((size_t) MAX_CAPS + 1, sizeof(int));
+    int count, tests = 0;
+    int state = 0, ch = 0;
+
+    if (caps == NULL) {
+	return;
+    }
+    if ((count = compare_terminfo(name, caps)) < 0) {
+	sprintf(temp, "Cannot load the terminfo for %.*s", NAME_SIZE, name);
+	ptextln(temp);
+    } else if (count == 0) {
+	sprintf(temp, "No caps differ from %.*s", NAME_SIZE, name);
+	ptextln(temp);
+    } else {
+	int n;
+
+	sprintf(temp, "Caps that differ from %.*s:", NAME_SIZE, name);
+	ptextln(temp);
+	for (n = 0; n < count; n++) {
+	    sprintf(temp, "%s ", ordinal_name(caps[n]));
+	    ptext(temp);
+	}
+	put_newlines(1);
+	control_init();
+	pad_results_reset();
+	if (tty_can_sync == SYNC_NOT_TESTED) {
+	    verify_time();
+	}
+	tests = menu_test_caps(NULL, caps, &state, &ch);
+    }
+    if (batch_mode) {
+	fprintf(stderr, "%s: %d caps differ from %s, %d tests run\n",
+		tty_basename, count < 0 ? 0 : count, name, tests);
+    }
+    free(caps);
+}
+
 /*
 **	show_usage()
 **
@@ -555,7 +614,8 @@ void
 show_usage(
 	      const char *name)
 {
-    (void) fprintf(stderr, "usage: %s [-diltV] [term]\n", name);
+    (void) fprintf(stderr, "usage: %s [-bcdilrtvV] [-D file] [-o term] [-R file [-f]] [term]\n", name);
+    (void) fprintf(stderr, "       %s [-cdilrtv] [-j jobs] term term...\n", name);
 }
 
 /*
@@ -599,6 +659,24 @@ TackMsg(const char *fmt, ...)
 }
 #endif
 
+/*
+**	batch_filename(name)
+**
+**	In batch mode, name the file after the terminal, e.g., xterm.debug.trc,
+**	so that copies of tack run in parallel by -j do not share it.
+*/
+static const char *
+batch_filename(const char *name)
+{
+    static char result[TEMP_SIZE];
+
+    if (!batch_mode) {
+	return name;
+    }
+    sprintf(result, "%.*s.%s", TEMP_SIZE - 20, tty_basename, name);
+    return result;
+}
+
 static char *
 validate_term(char *value)
 {
@@ -634,37 +712,70 @@ main(int argc, char *argv[])
     int i = 0, j = 0;
 #endif
     int ch;
+    int replay_fast = FALSE;
+    int want_cache = FALSE;
+    int want_trace = FALSE;
+    int want_log = FALSE;
+    int want_record = FALSE;
+    int jobs = 0;
+    char options[20];		/* options passed to the -j workers */
+    const char *replay_file = NULL;
+    const char *decode_file = NULL;
+    const char *retest_name = NULL;
 
     /* scan the option flags */
     send_reset_init = TRUE;
     translate_mode = FALSE;
     tty_can_sync = SYNC_NOT_TESTED;
-    while ((ch = getopt(argc, argv, "diltV")) != -1) {
+    strcpy(options, "-b");
+    while ((ch = getopt(argc, argv, "bcdD:fij:lo:rR:tvV")) != -1) {
+	if (strchr("cdilrtv", ch) != NULL && strchr(options, ch) == NULL) {
+	    sprintf(options + strlen(options), "%c", ch);
+	}
 	switch (ch) {
 	case 'V':
 	    print_version();
 	    ExitProgram(EXIT_FAILURE);
 	    /* NOTREACHED */
+	case 'b':
+	    batch_mode = TRUE;
+	    break;
+	case 'c':
+	    want_cache = TRUE;
+	    break;
 	case 'd':
-	    if ((debug_fp = fopen(DBG_FILENAME, "w")) == NULL) {
-		perror(DBG_FILENAME);
-		ExitProgram(EXIT_FAILURE);
-	    }
+	    want_trace = TRUE;
+	    break;
+	case 'D':
+	    decode_file = optarg;
+	    break;
+	case 'f':
+	    replay_fast = TRUE;
 	    break;
 	case 'i':
 	    send_reset_init = FALSE;
 	    break;
+	case 'j':
+	    jobs = atoi(optarg);
+	    break;
 	case 'l':
-	    if ((log_fp = fopen(LOG_FILENAME, "w"))) {
-		strcpy(logging_menu_entry, MENU_STOP_LOGGING);
-	    } else {
-		perror(LOG_FILENAME);
-		ExitProgram(EXIT_FAILURE);
-	    }
+	    want_log = TRUE;
+	    break;
+	case 'o':
+	    retest_name = optarg;
+	    break;
+	case 'r':
+	    want_record = TRUE;
+	    break;
+	case 'R':
+	    replay_file = optarg;
 	    break;
 	case 't':
 	    translate_mode = FALSE;
 	    break;
+	case 'v':
+	    verify_mode = TRUE;
+	    break;
 	default:
 	    show_usage(argv[0]);
 	    ExitProgram(EXIT_SUCCESS);
@@ -672,19 +783,68 @@ main(int argc, char *argv[])
 	}
     }
 
+    if (decode_file != NULL) {
+	trace_decode(decode_file);
+	ExitProgram(EXIT_SUCCESS);
+    }
+
+    if (replay_file != NULL) {
+	replay_session(replay_file, replay_fast);
+	ExitProgram(EXIT_SUCCESS);
+    }
+
     if (optind >= argc) {
 	tty_basename = validate_term(getenv("TERM"));
     } else if (optind + 1 >= argc) {
 	tty_basename = validate_term(argv[optind]);
+    } else if (!batch_mode) {
+	run_matrix(argv[0], options, &argv[optind], argc - optind, jobs);
+	ExitProgram(EXIT_SUCCESS);
     } else {
 	show_usage(argv[0]);
 	ExitProgram(EXIT_FAILURE);
     }
 
+    if (want_cache) {
+	cache_open(CACHE_FILENAME);
+    }
+    if (want_trace) {
+	trace_open(batch_filename(DBG_FILENAME));
+    }
+    if (want_log) {
+	const char *name = batch_filename(LOG_FILENAME);
+
+	if ((log_fp = fopen(name, "w"))) {
+	    strcpy(logging_menu_entry, MENU_STOP_LOGGING);
+	} else {
+	    perror(name);
+	    ExitProgram(EXIT_FAILURE);
+	}
+    }
+    if (want_record) {
+	record_open(batch_filename(REC_FILENAME));
+    }
+
     curses_setup(argv[0]);
+    if (verify_mode) {
+	verify_init();
+    }
 
     menu_can_scan(&normal_menu);	/* extract which caps can be tested */
-    menu_display(&start_menu, NULL);
+    if (retest_name != NULL) {
+	retest_terminfo(retest_name);
+    } else if (batch_mode) {
+	pad_results_reset();
+	menu_display(&pad_menu, NULL);
+	fprintf(stderr, "%s: %s, %lu characters per second\n",
+		tty_basename,
+		((tty_can_sync == SYNC_TESTED)
+		 ? "ENQ/ACK handshake"
+		 : "no handshake"),
+		tty_cps);
+    } else {
+	menu_display(&start_menu, NULL);
+    }
 
 #if TACK_CAN_EDIT
     if (user_modified()) {
@@ -709,7 +869,7 @@ ExitProgram(int code)
     free(tty_basename);
     del_curterm(cur_term);
     tack_edit_leaks();
-    tack_fun_leaks();
+    tack_arena_leaks();
 #if defined(HAVE_EXIT_TERMINFO)
     exit_terminfo(code);
 #elif defined(HAVE__NC_FREE_TINFO)
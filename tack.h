@@ -49,8 +49,8 @@
 #endif
 
 #if NO_LEAKS
+extern void tack_arena_leaks(void);
 extern void tack_edit_leaks(void);
-extern void tack_fun_leaks(void);
 #ifdef HAVE__NC_FREE_TINFO
 extern GCC_NORETURN void _nc_free_tinfo(int);
 #endif
@@ -119,6 +119,8 @@ extern char *strfnames[];
 #define STR_NAME(n) strnames[n]
 #endif
 
+#define MAX_CAPS (MAX_BOOLEAN + MAX_NUMBERS + (int) MAX_STRINGS)
+
 typedef enum {
     BOOLEAN,
     NUMBER,
@@ -147,10 +149,14 @@ typedef enum {
 #define TEMP_SIZE 1024
 
 #define LOG_FILENAME "tack.log"
-#define DBG_FILENAME "debug.log"
+#define DBG_FILENAME "debug.trc"
+#define REC_FILENAME "tack.rec"
+#define CACHE_FILENAME "tack.cache"
 
 extern FILE *log_fp;
 extern FILE *debug_fp;
+extern FILE *record_fp;
+extern int batch_mode;
 extern int debug_level;
 extern char temp[TEMP_SIZE];
 extern char *tty_basename;
@@ -166,9 +172,6 @@ extern int ignore_unused;
 #define SYNC_NEEDED	3
 
 extern int tty_can_sync;
-extern int total_pads_sent;	/* count pad characters sent */
-extern int total_caps_sent;	/* count caps sent */
-extern int total_printing_characters;	/* count printing characters sent */
 extern SIG_ATOMIC_T no_alarm_event;	/* TRUE if the alarm has not gone off yet */
 extern unsigned long usec_run_time;	/* length of last test in microseconds */
 extern int raw_characters_sent;	/* Total output characters */
@@ -177,7 +180,30 @@ extern int raw_characters_sent;	/* Total output characters */
 #define TIME_TEST 0
 #define TIME_SYNC 1
 #define TIME_FLUSH 2
-#define MAX_TIMERS 3
+#define TIME_TPUTS 3
+#define TIME_WRITE 4
+#define TIME_DRAIN 5
+#define TIME_KEYS 6
+#define MAX_TIMERS 7
+
+/* Instrumentation counters */
+#define CNT_WRITE_BYTES		0	/* characters written */
+#define CNT_WRITE_CALLS		1	/* flushes which wrote characters */
+#define CNT_FLUSHES		2	/* calls to flush_output() */
+#define CNT_WRITE_USEC		3	/* time spent in flush_output() */
+#define CNT_READ_BYTES		4	/* characters read */
+#define CNT_READ_CALLS		5	/* calls to getchar() or read() */
+#define CNT_SYNC_PROBES		6	/* ENQ/ACK handshakes */
+#define CNT_SYNC_FAILS		7	/* handshakes which timed out */
+#define CNT_TPUTS_USEC		8	/* time spent in tputs(), less writes */
+#define CNT_TPARM_USEC		9	/* time spent in tparm() */
+#define CNT_PAD_REQUESTED	10	/* milliseconds of padding requested */
+#define CNT_PAD_OBSERVED	11	/* milliseconds of delay measured */
+#define CNT_last		12
+
+extern unsigned long counter_value[CNT_last];
+#define COUNT_EVENT(n)	counter_value[n]++
+#define COUNT_ADD(n,v)	counter_value[n] += (unsigned long) (v)
 
 /* definitions for pad.c */
 
@@ -288,6 +314,8 @@ extern int tx_index[TT_MAX];	/* String index */
 extern int txp;			/* number of entries used */
 extern int tx_characters;	/* printing characters sent by test */
 extern unsigned long tx_cps;	/* characters per second */
+extern int tx_queue_peak;	/* most characters in the output queue */
+extern unsigned long tx_drain_cps;	/* characters per second leaving the queue */
 
 /*
 	Menu control for tack.
@@ -391,6 +419,7 @@ extern int getnext(int);
 extern int log_chr(FILE *, int, int);
 extern int tc_putp(const char *);
 extern int wait_here(void);
+extern void flush_output(void);
 extern void go_home(void);
 extern void home_down(void);
 extern void log_str(FILE *, const char *);
@@ -411,6 +440,7 @@ extern void putln(const char *);
 extern void read_string(char *, size_t);
 extern void tt_putp(const char *);
 extern void tt_putparm(NCURSES_CONST char *, int, int, int);
+extern void tt_putvalue(const char *, const char *, int);
 extern void tt_tputs(const char *, int);
 
 /* Solaris is out of step - humor it */
@@ -440,10 +470,14 @@ extern void dump_test_stats(TestList *, int *, int *);
 extern void event_start(int);
 extern void longer_augment(TestList *, int *, int *);
 extern void longer_test_time(TestList *, int *, int *);
+extern void pad_cap_swapped(int, const char *, const char *);
+extern void pad_results_reset(void);
 extern void pad_test_shutdown(TestList *, int);
 extern void pad_test_startup(int);
 extern void page_loop(void);
 extern void set_augment_txt(void);
+extern void show_cap_results(int);
+extern void show_counters(TestList *, int *, int *);
 extern void shorter_augment(TestList *, int *, int *);
 extern void shorter_test_time(TestList *, int *, int *);
 
@@ -465,16 +499,21 @@ extern void tools_sgr(TestList *, int *, int *);
 #if TACK_CAN_EDIT
 extern TestMenu change_pad_menu;
 extern TestList edit_test_list[];
+extern void patch_string(int, const char *);
 #define MY_PADS_MENU	{0, 0, NULL, NULL, "p) change padding", NULL, &change_pad_menu},
 #else
 #define MY_PADS_MENU		/* nothing */
 #endif
 extern const char *get_string_cap_byname(const char *, const char **);
 extern int cap_match(const char *names, const char *cap);
+extern int cap_ordinal(const char *);
+extern int compare_terminfo(const char *, int *);
 extern int get_string_cap_byvalue(const char *);
+extern const char *ordinal_name(int);
 extern int user_modified(void);
 extern void can_test(const char *, int);
 extern void cap_index(const char *, int *);
+extern void cap_ordinals(const char *, int *, int);
 extern void edit_init(void);
 extern void save_info(TestList *, int *, int *);
 extern void show_report(TestList *, int *, int *);
@@ -504,11 +543,16 @@ extern void scan_init(char *fn);
 /* sysdep.c */
 extern int compare_regex(const char *, const char *, const char *);
 extern int initial_stty_query(int);
+extern int read_reply(char *, size_t);
 extern int stty_query(int);
+extern int tty_open_pty(int *, int *);
+extern int tty_queued(void);
+extern int tty_read_input(int, char *, size_t, long);
 extern void ignoresig(void);
 extern void read_key(char *, size_t);
 extern void set_alarm_clock(int);
 extern void spin_flush(void);
+extern void tty_drain(void);
 extern void tty_init(void);
 extern void tty_raw(int, int);
 extern void tty_reset(void);
@@ -524,6 +568,7 @@ extern void menu_clear_screen(TestList *, int *, int *);
 extern void menu_display(TestMenu *, int *);
 extern void menu_prompt(void);
 extern void menu_reset_init(TestList *, int *, int *);
+extern int menu_test_caps(const TestMenu *, const int *, int *, int *);
 extern void pad_done_message(TestList *, int *, int *);
 
 /* modes.c */
@@ -532,6 +577,120 @@ extern TestList mode_test_list[];
 /* pad.c */
 extern TestList pad_test_list[];
 
+/* runner.c */
+extern void run_matrix(const char *, const char *, char **, int, int);
+
+/* cache.c */
+extern int cache_lookup(const char *, const char *, int *, int *);
+extern void cache_close(void);
+extern void cache_open(const char *);
+extern void cache_store(const char *, const char *, int, int);
+
+/* arena.c */
+typedef struct _arena_chunk ArenaChunk;
+typedef struct {
+    ArenaChunk *chunks;		/* newest chunk first */
+} Arena;
+extern Arena results_arena;
+extern Arena session_arena;
+extern char *arena_strdup(Arena *, const char *);
+extern void *arena_alloc(Arena *, size_t);
+extern void arena_free(Arena *);
+extern void arena_reset(Arena *);
+
+/* tinfo.c */
+extern char *tinfo_locate(const char *);
+extern void tinfo_report(const char *);
+extern int tinfo_extended(const char *, void (*)(NAME_TYPE, const char *));
+#if TACK_CAN_EDIT
+extern int tinfo_write(const char *, const char *, const TERMTYPE *, const TERMTYPE *, char *);
+#endif
+
+/* verify.c */
+#define VERIFY_UNKNOWN	0	/* nothing could be checked */
+#define VERIFY_OK	1	/* the screen is as expected */
+#define VERIFY_FAILED	2	/* the cursor or screen differs */
+extern int verify_mode;
+extern int verify_cursor(int *, int *);
+extern int verify_screen(TestList *, int, int, const char *);
+extern void verify_init(void);
+
+/* model.c */
+extern int model_active;
+extern int model_verify(TestList *);
+extern void model_cap(const char *, int, int);
+extern void model_char(int);
+extern void model_forget(void);
+extern void model_resume(int);
+extern void model_start(void);
+extern int model_suspend(void);
+extern void model_update(void);
+
+/* sgr.c */
+extern int sgr_changes;
+extern int sgr_coalesce;
+extern int sgr_dropped;
+extern int sgr_merged;
+extern void sgr_attr(int);
+extern void sgr_color(int, int);
+extern void sgr_flush(void);
+extern void sgr_forget(void);
+extern void sgr_start(int);
+
+/* utf8.c */
+extern TestList utf8_test_list[];
+
+/* flood.c */
+extern void input_flood(TestList *, int *, int *);
+
+/* redraw.c */
+extern void redraw_strategies(TestList *, int *, int *);
+
+/* record.c */
+#define RECORD_WRITE	'W'	/* characters sent to the terminal */
+#define RECORD_READ	'R'	/* characters read from the terminal */
+extern void record_char(int, int);
+extern void record_chars(int, const char *, size_t);
+extern void record_close(void);
+extern void record_flush(void);
+extern void record_open(const char *);
+extern void replay_session(const char *, int);
+
+/* trace.c */
+#define TR_MORE			0	/* continues text of previous event */
+#define TR_GETNEXT		1
+#define TR_GETNEXT_EOF		2
+#define TR_GETNEXT_EOF_NODELAY	3
+#define TR_GETNEXT_CHR		4
+#define TR_GETNEXT_CHR_NODELAY	5
+#define TR_TT_TPUTS		6
+#define TR_TT_PUTP		7
+#define TR_TT_PUTPARM		8
+#define TR_TC_PUTP		9
+#define TR_PUT_CLEAR		10
+#define TR_PUT_CLEAR_ERR	11
+#define TR_PUT_CLEAR_OK		12
+#define TR_TTY_RAW		13
+#define TR_TTY_RAW_NOTTY	14
+#define TR_TTY_RAW_DONE		15
+#define TR_TTY_SET		16
+#define TR_TTY_SET_NOTTY	17
+#define TR_TTY_SET_DONE		18
+#define TR_TTY_RESET		19
+#define TR_TTY_RESET_NOTTY	20
+#define TR_TTY_RESET_DONE	21
+#define TR_READ_KEY		22
+#define TR_READ_KEY_RESULT	23
+#define TR_SCAN_KEY		24
+#define TR_ABSENT		25
+#define TR_MESSAGE		26
+#define TR_DROPPED		27	/* events dropped while the buffer was full */
+extern void trace_close(void);
+extern void trace_decode(const char *);
+extern void trace_event(int, long, const char *);
+extern void trace_flush(void);
+extern void trace_open(const char *);
+
 /* sync.c */
 extern TestMenu sync_menu;
 extern int tty_sync_error(void);
@@ -540,6 +699,7 @@ extern void ask_version(TestList *, int *, int *);
 extern void flush_input(void);
 extern void sync_handshake(TestList *, int *, int *);
 extern void sync_test(TestMenu *);
+extern void tty_identity(char *, size_t);
 extern void verify_time(void);
 
 #endif /* NCURSES_TACK_H_incl */
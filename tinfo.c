@@ -0,0 +1,679 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+
+#include <tack.h>
+
+#include <sys/stat.h>
+
+MODULE_ID("$Id: tinfo.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Find, read and write compiled terminfo entries without running infocmp
+ * or tic.
+ *
+ * The directories are searched in the same order as ncurses does:
+ *
+ *	$TERMINFO
+ *	$HOME/.terminfo
+ *	$TERMINFO_DIRS, where an empty item stands for the default list
+ *	the default list, TACK_TERMINFO_DIRS
+ *
+ * The default list is the one ncurses was configured with, which the
+ * configure script gets from ncurses' config-script or pkg-config file.
+ * If it could not, the list here is a guess, and the report says so.
+ *
+ * An entry is a file named by the terminal name, in a subdirectory named
+ * by its first character (or on case-insensitive filesystems, that
+ * character in hexadecimal).  A name which is not a directory may be a
+ * hashed database, with or without a ".db" suffix.  Those cannot be read
+ * here, so a hashed database is reported as the source of the entry when
+ * it exists, noting that it cannot be read.
+ *
+ * With the edit support, the current terminal description can be written
+ * in compiled form, in the legacy format (16-bit numbers, up to 4096
+ * bytes) or the extended format (32-bit numbers, up to 32768 bytes), with
+ * the extended caps following the standard ones.  A number larger than
+ * 32767, e.g., pairs#0x10000 for a 256-color terminal, needs the extended
+ * format.
+ */
+
+#ifdef TACK_TERMINFO_DIRS
+#define TINFO_GUESSED	FALSE
+#else
+#define TACK_TERMINFO_DIRS "/etc/terminfo:/lib/terminfo:/usr/share/terminfo:/usr/lib/terminfo:/usr/share/lib/terminfo"
+#define TINFO_GUESSED	TRUE
+#endif
+
+#define DB_SUFFIX	".db"
+
+#define MAGIC_LEGACY	0432	/* numbers are 16 bits */
+#define MAGIC_INT32	01036	/* numbers are 32 bits */
+#define MAX_ENTRY_SIZE	32768
+#define MAX_LEGACY_NUM	32767	/* the largest number in the legacy format */
+
+#define LOW_MSB(p)	(UChar((p)[0]) | (UChar((p)[1]) << 8))
+
+/*
+**	tinfo_exists(path, type)
+**
+**	Return TRUE if the path exists and is a directory (type 'd') or a
+**	regular file (type 'f').
+*/
+static int
+tinfo_exists(
+		const char *path,
+		int type)
+{
+    struct stat sb;
+
+    if (stat(path, &sb) != 0) {
+	return FALSE;
+    }
+    return (type == 'd') ? S_ISDIR(sb.st_mode) : S_ISREG(sb.st_mode);
+}
+
+/*
+**	tinfo_lookup(dir, dir-length, name)
+**
+**	Look for the entry in one item of a directory list.  Return the path
+**	of the file or hashed database which would be used, or null.
+*/
+static char *
+tinfo_lookup(
+		const char *dir,
+		size_t length,
+		const char *name)
+{
+    char path[TEMP_SIZE];
+
+    if (length == 0 || length + strlen(name) + sizeof(DB_SUFFIX) + 4
+	> sizeof(path)) {
+	return NULL;
+    }
+    sprintf(path, "%.*s", (int) length, dir);
+    if (tinfo_exists(path, 'd')) {
+	sprintf(path + length, "/%c/%s", name[0], name);
+	if (tinfo_exists(path, 'f')) {
+	    return arena_strdup(&session_arena, path);
+	}
+	sprintf(path + length, "/%02x/%s", UChar(name[0]), name);
+	if (tinfo_exists(path, 'f')) {
+	    return arena_strdup(&session_arena, path);
+	}
+    } else if (tinfo_exists(path, 'f')) {
+	return arena_strdup(&session_arena, path);
+    } else {
+	strcat(path, DB_SUFFIX);
+	if (tinfo_exists(path, 'f')) {
+	    return arena_strdup(&session_arena, path);
+	}
+    }
+    return NULL;
+}
+
+/*
+**	tinfo_search(list, name, nested)
+**
+**	Look for the entry in a colon-separated list of directories.  An
+**	empty item in the list stands for the default list.
+*/
+static char *
+tinfo_search(
+		const char *list,
+		const char *name,
+		int nested)
+{
+    char *result = NULL;
+
+    while (result == NULL) {
+	const char *next = strchr(list, ':');
+	size_t length = next ? (size_t) (next - list) : strlen(list);
+
+	if (length != 0) {
+	    result = tinfo_lookup(list, length, name);
+	} else if (!nested) {
+	    result = tinfo_search(TACK_TERMINFO_DIRS, name, TRUE);
+	}
+	if (next == NULL) {
+	    break;
+	}
+	list = next + 1;
+    }
+    return result;
+}
+
+/*
+**	tinfo_locate(name)
+**
+**	Return the pathname of the compiled terminfo entry (or hashed
+**	database) which setupterm would use for the terminal, or null.
+*/
+char *
+tinfo_locate(
+		const char *name)
+{
+    char *result = NULL;
+    const char *value;
+
+    if (name == NULL || *name == '\0' || strchr(name, '/') != NULL) {
+	return NULL;
+    }
+    if ((value = getenv("TERMINFO")) != NULL && *value != '\0') {
+	result = tinfo_lookup(value, strlen(value), name);
+    }
+    if (result == NULL && (value = getenv("HOME")) != NULL && *value != '\0') {
+	char home[TEMP_SIZE];
+
+	sprintf(home, "%.*s/.terminfo", TEMP_SIZE - 20, value);
+	result = tinfo_lookup(home, strlen(home), name);
+    }
+    if (result == NULL && (value = getenv("TERMINFO_DIRS")) != NULL) {
+	result = tinfo_search(value, name, FALSE);
+    }
+    if (result == NULL) {
+	result = tinfo_search(TACK_TERMINFO_DIRS, name, TRUE);
+    }
+    return result;
+}
+
+/*
+**	tinfo_hashed(path)
+**
+**	Return TRUE if the file does not begin with the magic number of a
+**	compiled entry, i.e., it is a hashed database.
+*/
+static int
+tinfo_hashed(
+		const char *path)
+{
+    FILE *fp;
+    unsigned char magic[2];
+    int result = FALSE;
+
+    if ((fp = fopen(path, "rb")) != NULL) {
+	if (fread(magic, sizeof(char), sizeof(magic), fp) == sizeof(magic)) {
+	    int value = magic[0] | (magic[1] << 8);
+
+	    result = (value != MAGIC_LEGACY && value != MAGIC_INT32);
+	}
+	fclose(fp);
+    }
+    return result;
+}
+
+/*
+**	tinfo_report(path)
+**
+**	Tell where the terminal description came from, as found by
+**	tinfo_locate(), and whether that could be relied upon.
+*/
+void
+tinfo_report(
+		const char *path)
+{
+    if (path != NULL) {
+	ptext("Using terminfo from: ");
+	ptextln(path);
+	if (tinfo_hashed(path)) {
+	    ptextln("That is a hashed database, which tack cannot read.");
+	}
+    }
+    if (TINFO_GUESSED) {
+	ptextln("The terminfo search list is a guess, not the one from ncurses.");
+    }
+    if (path != NULL || TINFO_GUESSED) {
+	put_crlf();
+    }
+}
+
+/*
+**	tinfo_short(buffer, offset)
+**
+**	Return the 16-bit number at the offset, with 0177777 and 0177776
+**	(absent and cancelled) as -1 and -2.
+*/
+static int
+tinfo_short(
+	       const char *buffer,
+	       size_t offset)
+{
+    int value = LOW_MSB(buffer + offset);
+
+    return (value >= 0177776) ? (value - 0200000) : value;
+}
+
+/*
+**	tinfo_extended(path, func)
+**
+**	Read the names of the extended caps from a compiled terminfo entry,
+**	calling the function with the type and name of each.  Return the
+**	number of names, or -1 if the entry cannot be read.
+*/
+int
+tinfo_extended(
+		  const char *path,
+		  void (*func) (NAME_TYPE, const char *))
+{
+    FILE *fp;
+    char *buffer;
+    size_t length, offset, table, base;
+    size_t number_size;
+    int header[5], n, total;
+    int result = -1;
+
+    if (path == NULL || (fp = fopen(path, "rb")) == NULL) {
+	return -1;
+    }
+    if ((buffer = (char *) malloc((size_t) MAX_ENTRY_SIZE)) == NULL) {
+	fclose(fp);
+	return -1;
+    }
+    length = fread(buffer, sizeof(char), (size_t) MAX_ENTRY_SIZE, fp);
+    fclose(fp);
+
+    if (length < 12) {
+	free(buffer);
+	return -1;
+    }
+    switch (tinfo_short(buffer, 0)) {
+    case MAGIC_LEGACY:
+	number_size = 2;
+	break;
+    case MAGIC_INT32:
+	number_size = 4;
+	break;
+    default:
+	free(buffer);
+	return -1;
+    }
+    for (n = 0; n < 5; n++) {
+	if ((header[n] = tinfo_short(buffer, (size_t) (2 + 2 * n))) < 0) {
+	    free(buffer);
+	    return -1;
+	}
+    }
+    /* skip the names, booleans, numbers, string offsets and string table */
+    offset = 12 + (size_t) (header[0] + header[1]);
+    offset += (offset & 1);
+    offset += (size_t) header[2] * number_size;
+    offset += (size_t) header[3] * 2 + (size_t) header[4];
+    offset += (offset & 1);
+
+    result = 0;
+    if (offset + 10 <= length) {
+	/* the extended header has the counts of booleans, numbers and
+	 * strings, the number of string offsets and the string table size */
+	for (n = 0; n < 5; n++) {
+	    if ((header[n] = tinfo_short(buffer, offset + (size_t) (2 * n))) < 0) {
+		free(buffer);
+		return -1;
+	    }
+	}
+	total = header[0] + header[1] + header[2];
+	offset += 10 + (size_t) header[0];
+	offset += (offset & 1);
+	offset += (size_t) header[1] * number_size;
+	table = offset + (size_t) header[3] * 2;
+	if (header[3] < header[2] + total
+	    || table + (size_t) header[4] > length) {
+	    free(buffer);
+	    return -1;
+	}
+	/* the names follow the last of the string values */
+	for (n = 0, base = 0; n < header[2]; n++) {
+	    int value = tinfo_short(buffer, offset + (size_t) (2 * n));
+
+	    if (value >= 0 && value < header[4]) {
+		const char *s = buffer + table + value;
+		const char *t = memchr(s, '\0', (size_t) (header[4] - value));
+
+		if (t != NULL && (size_t) (t + 1 - (buffer + table)) > base) {
+		    base = (size_t) (t + 1 - (buffer + table));
+		}
+	    }
+	}
+	for (n = 0; n < total; n++) {
+	    int value = tinfo_short(buffer, offset + (size_t) (2 * (header[2] + n)));
+	    NAME_TYPE type = ((n < header[0])
+			      ? BOOLEAN
+			      : ((n < header[0] + header[1])
+				 ? NUMBER
+				 : STRING));
+
+	    if (value < 0
+		|| base + (size_t) value >= (size_t) header[4]
+		|| memchr(buffer + table + base + value, '\0',
+			  (size_t) header[4] - base - (size_t) value) == NULL) {
+		continue;
+	    }
+	    (*func) (type, buffer + table + base + value);
+	    ++result;
+	}
+    }
+    free(buffer);
+    return result;
+}
+
+#if TACK_CAN_EDIT
+
+#ifndef ABSENT_NUMERIC
+#define ABSENT_NUMERIC	(-1)
+#endif
+
+typedef struct {
+    char *buffer;
+    size_t used;
+    size_t size;
+} TinfoBuffer;
+
+/*
+**	tinfo_put(out, data, length)
+**
+**	Append bytes to the compiled entry.  Past the end of the buffer,
+**	only count them.
+*/
+static void
+tinfo_put(
+	     TinfoBuffer * out,
+	     const char *data,
+	     size_t length)
+{
+    if (out->used + length <= out->size) {
+	memcpy(out->buffer + out->used, data, length);
+    }
+    out->used += length;
+}
+
+/*
+**	tinfo_put_number(out, value, size)
+**
+**	Append a 16- or 32-bit little-endian number to the compiled entry.
+*/
+static void
+tinfo_put_number(
+		    TinfoBuffer * out,
+		    int value,
+		    size_t size)
+{
+    char data[4];
+    size_t n;
+
+    for (n = 0; n < size; n++) {
+	data[n] = (char) (((unsigned) value >> (8 * n)) & 0377);
+    }
+    tinfo_put(out, data, size);
+}
+
+/*
+**	tinfo_put_even(out)
+**
+**	Pad the compiled entry to an even offset.
+*/
+static void
+tinfo_put_even(
+		  TinfoBuffer * out)
+{
+    if (out->used & 1) {
+	tinfo_put(out, "", (size_t) 1);
+    }
+}
+
+/*
+**	tinfo_put_offsets(out, strings, count, offset)
+**
+**	Append the offsets of the strings in a string table which begins at
+**	the given offset.  Return the offset following the strings.
+*/
+static int
+tinfo_put_offsets(
+		     TinfoBuffer * out,
+		     char *const *strings,
+		     int count,
+		     int offset)
+{
+    int n;
+
+    for (n = 0; n < count; n++) {
+	if (strings[n] == ABSENT_STRING) {
+	    tinfo_put_number(out, -1, (size_t) 2);
+	} else if (strings[n] == CANCELLED_STRING) {
+	    tinfo_put_number(out, -2, (size_t) 2);
+	} else {
+	    tinfo_put_number(out, offset, (size_t) 2);
+	    offset += (int) strlen(strings[n]) + 1;
+	}
+    }
+    return offset;
+}
+
+/*
+**	tinfo_put_strings(out, strings, count)
+**
+**	Append the valid strings to the string table.
+*/
+static void
+tinfo_put_strings(
+		     TinfoBuffer * out,
+		     char *const *strings,
+		     int count)
+{
+    int n;
+
+    for (n = 0; n < count; n++) {
+	if (VALID_STRING(strings[n])) {
+	    tinfo_put(out, strings[n], strlen(strings[n]) + 1);
+	}
+    }
+}
+
+/*
+**	tinfo_number(tp, saved, n)
+**
+**	Return a number from the terminal description.  The numbers in a
+**	TERMTYPE are shorts, which ncurses clamps to 32767.  With extended
+**	colors, ncurses keeps the full value in the TERMTYPE2 of the current
+**	terminal, which tigetnum() reads.  That is used only if the number is
+**	unchanged from the saved description, i.e., was not edited.
+*/
+static int
+tinfo_number(
+		const TERMTYPE *tp,
+		const TERMTYPE *saved,
+		int n)
+{
+    int value = tp->Numbers[n];
+
+#if NCURSES_EXT_COLORS
+    if (value == MAX_LEGACY_NUM
+	&& tp == CUR_TP
+	&& saved != NULL
+	&& n < NUM_NUMBERS(saved)
+	&& saved->Numbers[n] == value) {
+	NCURSES_CONST char *name = (ExtNumname(tp, n, numnames));
+	int wide = tigetnum(name);
+
+	if (wide > value) {
+	    value = wide;
+	}
+    }
+#else
+    (void) saved;
+#endif
+    return value;
+}
+
+/*
+**	tinfo_encode(out, names, tp, saved, magic)
+**
+**	Encode the terminal description in the compiled format given by the
+**	magic number.  Return TRUE if it fits the size and number limits of
+**	the format.
+*/
+static int
+tinfo_encode(
+		TinfoBuffer * out,
+		const char *names,
+		const TERMTYPE *tp,
+		const TERMTYPE *saved,
+		int magic)
+{
+    size_t number_size = (magic == MAGIC_INT32) ? 4 : 2;
+    int num_b = NUM_BOOLEANS(tp);
+    int num_n = NUM_NUMBERS(tp);
+    int num_s = NUM_STRINGS(tp);
+    int ext_b = 0, ext_n = 0, ext_s = 0;
+    int n, size, value;
+    int fits = TRUE;
+
+#if NCURSES_XNAMES
+    ext_b = tp->ext_Booleans;
+    ext_n = tp->ext_Numbers;
+    ext_s = tp->ext_Strings;
+    num_b -= ext_b;
+    num_n -= ext_n;
+    num_s -= ext_s;
+#endif
+    /* like tic, leave out the absent caps at the end of each section */
+    while (num_b > 0 && tp->Booleans[num_b - 1] == FALSE)
+	--num_b;
+    while (num_n > 0 && tp->Numbers[num_n - 1] == ABSENT_NUMERIC)
+	--num_n;
+    while (num_s > 0 && tp->Strings[num_s - 1] == ABSENT_STRING)
+	--num_s;
+
+    out->used = 0;
+    out->size = (magic == MAGIC_INT32) ? MAX_ENTRY_SIZE : 4096;
+
+    tinfo_put_number(out, magic, (size_t) 2);
+    tinfo_put_number(out, (int) strlen(names) + 1, (size_t) 2);
+    tinfo_put_number(out, num_b, (size_t) 2);
+    tinfo_put_number(out, num_n, (size_t) 2);
+    tinfo_put_number(out, num_s, (size_t) 2);
+    for (n = 0, size = 0; n < num_s; n++) {
+	if (VALID_STRING(tp->Strings[n]))
+	    size += (int) strlen(tp->Strings[n]) + 1;
+    }
+    tinfo_put_number(out, size, (size_t) 2);
+
+    tinfo_put(out, names, strlen(names) + 1);
+    for (n = 0; n < num_b; n++) {
+	tinfo_put_number(out, tp->Booleans[n], (size_t) 1);
+    }
+    tinfo_put_even(out);
+    for (n = 0; n < num_n; n++) {
+	value = tinfo_number(tp, saved, n);
+	if (value > MAX_LEGACY_NUM && magic == MAGIC_LEGACY) {
+	    fits = FALSE;
+	}
+	tinfo_put_number(out, value, number_size);
+    }
+    (void) tinfo_put_offsets(out, tp->Strings, num_s, 0);
+    tinfo_put_strings(out, tp->Strings, num_s);
+
+#if NCURSES_XNAMES
+    if (ext_b + ext_n + ext_s > 0) {
+	int total = ext_b + ext_n + ext_s;
+	char *const *ext_strings = tp->Strings + NUM_STRINGS(tp) - ext_s;
+
+	for (n = 0, size = 0; n < ext_s; n++) {
+	    if (VALID_STRING(ext_strings[n]))
+		size += (int) strlen(ext_strings[n]) + 1;
+	}
+	for (n = 0; n < total; n++) {
+	    size += (int) strlen(tp->ext_Names[n]) + 1;
+	}
+	tinfo_put_even(out);
+	tinfo_put_number(out, ext_b, (size_t) 2);
+	tinfo_put_number(out, ext_n, (size_t) 2);
+	tinfo_put_number(out, ext_s, (size_t) 2);
+	tinfo_put_number(out, ext_s + total, (size_t) 2);
+	tinfo_put_number(out, size, (size_t) 2);
+	for (n = 0; n < ext_b; n++) {
+	    tinfo_put_number(out,
+			     tp->Booleans[NUM_BOOLEANS(tp) - ext_b + n],
+			     (size_t) 1);
+	}
+	tinfo_put_even(out);
+	for (n = 0; n < ext_n; n++) {
+	    value = tinfo_number(tp, saved, NUM_NUMBERS(tp) - ext_n + n);
+	    if (value > MAX_LEGACY_NUM && magic == MAGIC_LEGACY) {
+		fits = FALSE;
+	    }
+	    tinfo_put_number(out, value, number_size);
+	}
+	(void) tinfo_put_offsets(out, ext_strings, ext_s, 0);
+	/* the name offsets are relative to the end of the string values */
+	(void) tinfo_put_offsets(out, tp->ext_Names, total, 0);
+	tinfo_put_strings(out, ext_strings, ext_s);
+	tinfo_put_strings(out, tp->ext_Names, total);
+    }
+#endif
+    return fits && (out->used <= out->size);
+}
+
+/*
+**	tinfo_write(dir, names, tp, saved, path)
+**
+**	Write the terminal description in compiled form to the terminfo
+**	directory, creating it if needed, so that setupterm can read it with
+**	$TERMINFO set to that directory.  The saved description is the one
+**	which was loaded, before any edits.  The legacy format is used if the
+**	entry fits in it, otherwise the format with 32-bit numbers, which
+**	allows larger entries and numbers.  The pathname of the file is
+**	returned in the path buffer, which must hold TEMP_SIZE characters.
+**	Return TRUE if the file was written.
+*/
+int
+tinfo_write(
+	       const char *dir,
+	       const char *names,
+	       const TERMTYPE *tp,
+	       const TERMTYPE *saved,
+	       char *path)
+{
+    TinfoBuffer out;
+    FILE *fp;
+    size_t length;
+    int result = FALSE;
+
+    length = strcspn(names, "|");
+    if (length == 0
+	|| strlen(dir) + length + 8 > TEMP_SIZE
+	|| (out.buffer = (char *) malloc((size_t) MAX_ENTRY_SIZE)) == NULL) {
+	return FALSE;
+    }
+    if (tinfo_encode(&out, names, tp, saved, MAGIC_LEGACY)
+	|| tinfo_encode(&out, names, tp, saved, MAGIC_INT32)) {
+	sprintf(path, "%s/%c", dir, names[0]);
+	(void) mkdir(dir, 0755);
+	(void) mkdir(path, 0755);
+	sprintf(path, "%s/%c/%.*s", dir, names[0], (int) length, names);
+	if ((fp = fopen(path, "wb")) != NULL) {
+	    result = (fwrite(out.buffer, sizeof(char), out.used, fp) == out.used);
+	    if (fclose(fp) != 0) {
+		result = FALSE;
+	    }
+	}
+    }
+    free(out.buffer);
+    return result;
+}
+#endif /* TACK_CAN_EDIT */
@@ -0,0 +1,329 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+#include <tack.h>
+
+#if HAVE_SYS_TIME_H
+#include <sys/time.h>
+#endif
+
+MODULE_ID("$Id: trace.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Binary debug trace.
+ *
+ * Each event is stored as a fixed-size record in a ring buffer, which is
+ * written to the debug-file only when tack is about to wait for input, or
+ * when the program exits, so that the timing tests do not wait for it.
+ * Events which come while the buffer is full are dropped, and their number
+ * is recorded in a TR_DROPPED record.  Strings which do not fit in one
+ * record are continued in TR_MORE records.  The -D option decodes
+ * the file into the text format which the -d option used to write.
+ */
+
+#define TRACE_MAGIC	"TACKTRC1"
+#define TRACE_RING	8192	/* records buffered between writes */
+#define TRACE_TEXT	24	/* text bytes per record */
+
+#define TRACE_NULL	255	/* length marking a null string */
+#define TRACE_CANCEL	254	/* length marking a cancelled string */
+
+typedef struct {
+    unsigned char event;	/* TR_xxx code */
+    unsigned char length;	/* bytes of text[] used */
+    unsigned long usec;		/* microseconds since trace_open() */
+    long value;			/* numeric payload */
+    char text[TRACE_TEXT];	/* string payload, not null-terminated */
+} TraceRecord;
+
+/* how the decoder displays the text payload */
+#define SHOW_NONE	0	/* no text */
+#define SHOW_LOG	1	/* text is rendered with log_str() */
+#define SHOW_RAW	2	/* text is written as-is */
+
+typedef struct {
+    int event;
+    const char *prefix;		/* printed before the text */
+    int show;			/* SHOW_xxx */
+    const char *suffix;		/* printf format using the value */
+} TraceFormat;
+
+static const TraceFormat trace_formats[] =
+{
+    {TR_GETNEXT, "getnext:\n", SHOW_NONE, NULL},
+    {TR_GETNEXT_EOF, "...getnext: EOF", SHOW_NONE, "\n"},
+    {TR_GETNEXT_EOF_NODELAY, "...getnext: EOF (nodelay)", SHOW_NONE, "\n"},
+    {TR_GETNEXT_CHR, "...getnext: ", SHOW_NONE, "0x%02lX\n"},
+    {TR_GETNEXT_CHR_NODELAY, "...getnext: ", SHOW_NONE, "0x%02lX (nodelay)\n"},
+    {TR_TT_TPUTS, "tt_tputs: string=", SHOW_LOG, ", reps=%ld\n"},
+    {TR_TT_PUTP, "tt_putp: string=", SHOW_LOG, "\n"},
+    {TR_TT_PUTPARM, "tc_putparm: string=", SHOW_LOG, ", reps=%ld\n"},
+    {TR_TC_PUTP, "tc_putp: string=", SHOW_LOG, ", rc=%ld\n"},
+    {TR_PUT_CLEAR, "put_clear:\n", SHOW_NONE, NULL},
+    {TR_PUT_CLEAR_ERR, "...put_clear: ERR\n", SHOW_NONE, NULL},
+    {TR_PUT_CLEAR_OK, "...put_clear: OK\n", SHOW_NONE, NULL},
+    {TR_TTY_RAW, "tty_raw:\n", SHOW_NONE, NULL},
+    {TR_TTY_RAW_NOTTY, "...tty_raw: not a tty\n", SHOW_NONE, NULL},
+    {TR_TTY_RAW_DONE, "...tty_raw: done\n", SHOW_NONE, NULL},
+    {TR_TTY_SET, "tty_set:\n", SHOW_NONE, NULL},
+    {TR_TTY_SET_NOTTY, "...tty_set: not a tty\n", SHOW_NONE, NULL},
+    {TR_TTY_SET_DONE, "...tty_set: done\n", SHOW_NONE, NULL},
+    {TR_TTY_RESET, "tty_reset:\n", SHOW_NONE, NULL},
+    {TR_TTY_RESET_NOTTY, "...tty_reset: not a tty\n", SHOW_NONE, NULL},
+    {TR_TTY_RESET_DONE, "...tty_reset: done\n", SHOW_NONE, NULL},
+    {TR_READ_KEY, "read_key: max=", SHOW_NONE, "%lu\n"},
+    {TR_READ_KEY_RESULT, "...read_key: result=", SHOW_LOG, "\n"},
+    {TR_SCAN_KEY, "", SHOW_NONE, "%02lX "},
+    {TR_ABSENT, "ABSENT ", SHOW_RAW, "\n"},
+    {TR_MESSAGE, "", SHOW_RAW, "\n"},
+    {TR_DROPPED, "...trace: ", SHOW_NONE, "%ld events dropped\n"},
+    {-1, NULL, SHOW_NONE, NULL}
+};
+
+static TraceRecord trace_ring[TRACE_RING];
+static int trace_used;		/* number of records in trace_ring[] */
+static long trace_dropped;	/* events dropped since the last write */
+
+#if HAVE_GETTIMEOFDAY
+static struct timeval trace_epoch;
+#else
+static time_t trace_epoch;
+#endif
+
+/*
+**	trace_open(filename)
+**
+**	Open the debug-file and write the trace header.
+*/
+void
+trace_open(const char *filename)
+{
+    if ((debug_fp = fopen(filename, "wb")) == NULL) {
+	perror(filename);
+	ExitProgram(EXIT_FAILURE);
+    }
+#if HAVE_GETTIMEOFDAY
+    (void) gettimeofday(&trace_epoch, (struct timezone *) 0);
+#else
+    trace_epoch = time((time_t *) 0);
+#endif
+    trace_used = 0;
+    trace_dropped = 0;
+    fputs(TRACE_MAGIC, debug_fp);
+    fputc((int) sizeof(TraceRecord), debug_fp);
+}
+
+/*
+**	trace_flush()
+**
+**	Write the buffered trace records to the debug-file, noting the
+**	events which were dropped.  Call this only where tack is about to
+**	wait, since it may be slow.
+*/
+void
+trace_flush(void)
+{
+    if (debug_fp && trace_dropped) {
+	/* the last slot is kept for this record */
+	long dropped = trace_dropped;
+
+	trace_dropped = 0;
+	trace_event(TR_DROPPED, dropped, NULL);
+    }
+    if (debug_fp && trace_used) {
+	IGNORE_RC(fwrite(trace_ring, sizeof(TraceRecord), (size_t) trace_used, debug_fp));
+	fflush(debug_fp);
+	trace_used = 0;
+    }
+}
+
+/*
+**	trace_close()
+**
+**	Write the last trace records and close the debug-file.
+*/
+void
+trace_close(void)
+{
+    if (debug_fp) {
+	trace_flush();
+	fclose(debug_fp);
+	debug_fp = NULL;
+    }
+}
+
+/*
+**	trace_event(event, value, text)
+**
+**	Add an event to the trace buffer.  The text may be null.  If the
+**	buffer is full, count the event as dropped.
+*/
+void
+trace_event(int event, long value, const char *text)
+{
+    TraceRecord *tr;
+    size_t length;
+
+    do {
+	if (event != TR_DROPPED && trace_used >= TRACE_RING - 1) {
+	    trace_dropped++;
+	    break;
+	}
+	tr = &trace_ring[trace_used++];
+	tr->event = (unsigned char) event;
+	tr->value = value;
+#if HAVE_GETTIMEOFDAY
+	{
+	    struct timeval current_time;
+
+	    (void) gettimeofday(&current_time, (struct timezone *) 0);
+	    tr->usec = (unsigned long) (((current_time.tv_sec - trace_epoch.tv_sec) * 1000000)
+					+ current_time.tv_usec - trace_epoch.tv_usec);
+	}
+#else
+	tr->usec = (unsigned long) (time((time_t *) 0) - trace_epoch) * 1000000;
+#endif
+	if (text == NULL) {
+	    tr->length = TRACE_NULL;
+	    break;
+	} else if (text == CANCELLED_STRING) {
+	    tr->length = TRACE_CANCEL;
+	    break;
+	}
+	for (length = 0; length < TRACE_TEXT && text[length] != '\0'; ++length) {
+	    tr->text[length] = text[length];
+	}
+	tr->length = (unsigned char) length;
+	text += length;
+	event = TR_MORE;
+    } while (*text != '\0');
+}
+
+/*
+**	decode_event(tr, text, column)
+**
+**	Write one trace event in text form.  Return the updated column used
+**	for wrapping the scan-code dump.
+*/
+static int
+decode_event(const TraceRecord *tr, const char *text, int column)
+{
+    const TraceFormat *tf;
+
+    for (tf = trace_formats; tf->prefix != NULL; ++tf) {
+	if (tf->event == (int) tr->event)
+	    break;
+    }
+    if (tf->prefix == NULL) {
+	printf("?? event %d\n", tr->event);
+	return column;
+    }
+    fputs(tf->prefix, stdout);
+    switch (tf->show) {
+    case SHOW_LOG:
+	log_str(stdout, text);
+	break;
+    case SHOW_RAW:
+	fputs(text ? text : "(null)", stdout);
+	break;
+    }
+    if (tf->suffix != NULL) {
+	printf(tf->suffix, tr->value);
+    }
+    if (tr->event == TR_SCAN_KEY) {
+	column += 3;
+	if (column > 72) {
+	    printf("\n");
+	    column = 0;
+	}
+    }
+    return column;
+}
+
+/*
+**	trace_decode(filename)
+**
+**	Write a binary trace file to the standard output in text form.
+*/
+void
+trace_decode(const char *filename)
+{
+    FILE *fp;
+    char magic[sizeof(TRACE_MAGIC)];
+    TraceRecord this_rec, last_rec;
+    char *text = NULL;
+    size_t text_len = 0;
+    size_t text_max = 0;
+    int have_last = FALSE;
+    int column = 0;
+
+    if ((fp = fopen(filename, "rb")) == NULL) {
+	perror(filename);
+	ExitProgram(EXIT_FAILURE);
+    }
+    if (fread(magic, sizeof(char), sizeof(magic) - 1, fp) != sizeof(magic) - 1
+	|| strncmp(magic, TRACE_MAGIC, sizeof(magic) - 1)
+	|| fgetc(fp) != (int) sizeof(TraceRecord)) {
+	fprintf(stderr, "%s: not a tack trace file\n", filename);
+	fclose(fp);
+	ExitProgram(EXIT_FAILURE);
+    }
+    memset(&last_rec, 0, sizeof(last_rec));
+    while (fread(&this_rec, sizeof(this_rec), (size_t) 1, fp) == 1) {
+	if (this_rec.event != TR_MORE) {
+	    if (have_last) {
+		column = decode_event(&last_rec,
+				      ((last_rec.length == TRACE_NULL)
+				       ? NULL
+				       : ((last_rec.length == TRACE_CANCEL)
+					  ? CANCELLED_STRING
+					  : text)),
+				      column);
+	    }
+	    last_rec = this_rec;
+	    have_last = TRUE;
+	    text_len = 0;
+	}
+	if (this_rec.length <= TRACE_TEXT) {
+	    if (text_len + TRACE_TEXT + 1 > text_max) {
+		text_max = text_len + TRACE_TEXT + 1 + text_max;
+		text = realloc(text, text_max);
+		if (text == NULL) {
+		    fprintf(stderr, "%s: out of memory\n", filename);
+		    ExitProgram(EXIT_FAILURE);
+		}
+	    }
+	    memcpy(text + text_len, this_rec.text, (size_t) this_rec.length);
+	    text_len += this_rec.length;
+	    text[text_len] = '\0';
+	}
+    }
+    if (have_last) {
+	(void) decode_event(&last_rec,
+			    ((last_rec.length == TRACE_NULL)
+			     ? NULL
+			     : ((last_rec.length == TRACE_CANCEL)
+				? CANCELLED_STRING
+				: text)),
+			    column);
+    }
+    free(text);
+    fclose(fp);
+}
@@ -0,0 +1,262 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+
+#include <tack.h>
+
+MODULE_ID("$Id: utf8.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * UTF-8 text tests.
+ *
+ * The rest of tack writes one byte per cell.  These tests write samples of
+ * UTF-8 text whose characters take up one or two columns, or none for the
+ * combining marks, and check how far the cursor moved with the cursor
+ * position report (u7) (u6).  The throughput test times a screen full of
+ * each sample, since a terminal which is fast with ASCII may be much slower
+ * when it has to look up wide or combined characters.
+ *
+ * The samples are written as bytes; tack does not need a UTF-8 locale, but
+ * the terminal must be set to UTF-8.
+ */
+
+static void utf8_width(TestList *, int *, int *);
+static void utf8_throughput(TestList *, int *, int *);
+
+/* *INDENT-OFF* */
+TestList utf8_test_list[] =
+{
+    MY_EDIT_MENU
+    {MENU_NEXT, 0, NULL, NULL, "w) cursor advance of wide and combining characters", utf8_width, NULL},
+    {MENU_NEXT, 0, NULL, NULL, "t) UTF-8 text throughput", utf8_throughput, NULL},
+    {MENU_LAST, 0, NULL, NULL, NULL, NULL, NULL}
+};
+/* *INDENT-ON* */
+
+typedef struct {
+    const char *name;
+    const char *text;		/* UTF-8 */
+    int glyphs;			/* characters as displayed */
+    int width;			/* columns */
+} Utf8Sample;
+
+/* *INDENT-OFF* */
+static const Utf8Sample utf8_samples[] =
+{
+    /* "abcdefgh" */
+    {"ASCII",     "abcdefgh", 8, 8},
+    /* a-grave, e-acute, i-circumflex, o-tilde, u-diaeresis, c-cedilla, n-tilde, sharp-s */
+    {"Latin-1",   "\303\240\303\251\303\256\303\265\303\274\303\247\303\261\303\237", 8, 8},
+    /* U+4E2D U+6587 U+6F22 U+5B57 */
+    {"CJK",       "\344\270\255\346\226\207\346\274\242\345\255\227", 4, 8},
+    /* e a o u, each followed by a combining acute, diaeresis, circumflex, grave */
+    {"combining", "e\314\201a\314\210o\314\202u\314\200", 4, 4},
+    /* U+1F600 U+1F30D U+1F680 U+1F355 */
+    {"emoji",     "\360\237\230\200\360\237\214\215\360\237\232\200\360\237\215\225", 4, 8}
+};
+/* *INDENT-ON* */
+
+#define NUM_SAMPLES	(int) (sizeof(utf8_samples) / sizeof(utf8_samples[0]))
+
+#define UTF8_REPEAT	4	/* copies of a sample written for the check */
+
+#define UTF8_UNKNOWN	0	/* the terminal did not report the cursor */
+#define UTF8_OK		1	/* the cursor moved as expected */
+#define UTF8_WRONG	2	/* the cursor moved some other distance */
+
+/*
+**	put_utf8(text)
+**
+**	Send a UTF-8 string, a byte at a time.
+*/
+static void
+put_utf8(const char *text)
+{
+    while (*text != '\0') {
+	put_this(UChar(*text++));
+    }
+}
+
+/*
+**	utf8_check(sample, moved)
+**
+**	Write a few copies of the sample, and ask the terminal how far the
+**	cursor moved.
+*/
+static int
+utf8_check(
+	      const Utf8Sample * p,
+	      int *moved)
+{
+    int row0, col0, row1, col1, n;
+
+    *moved = 0;
+    if (!verify_cursor(&row0, &col0)) {
+	return UTF8_UNKNOWN;
+    }
+    for (n = 0; n < UTF8_REPEAT; n++) {
+	put_utf8(p->text);
+    }
+    char_count += UTF8_REPEAT * p->width;
+    if (!verify_cursor(&row1, &col1)) {
+	return UTF8_UNKNOWN;
+    }
+    *moved = ((row1 - row0) * columns) + (col1 - col0);
+    return (*moved == UTF8_REPEAT * p->width) ? UTF8_OK : UTF8_WRONG;
+}
+
+/*
+**	utf8_width(test_list, status, ch)
+**
+**	Check the cursor advance for each sample with (u7) (u6).
+*/
+static void
+utf8_width(
+	      TestList * t,
+	      int *state,
+	      int *ch)
+{
+    int n, moved;
+
+    if (!VALID_STRING(user7) || !VALID_STRING(user6)) {
+	ptext("(u7) (u6) The terminal cannot report the cursor position.  ");
+	generic_done_message(t, state, ch);
+	return;
+    }
+    put_clear();
+    ptextln("Each line shows a sample of UTF-8 text, and how far the cursor moved.");
+    put_crlf();
+    for (n = 0; n < NUM_SAMPLES; n++) {
+	const Utf8Sample *p = &utf8_samples[n];
+	int result;
+
+	sprintf(temp, "%-12s", p->name);
+	put_str(temp);
+	result = utf8_check(p, &moved);
+	put_str("  ");
+	switch (result) {
+	case UTF8_OK:
+	    sprintf(temp, "%d columns", moved);
+	    break;
+	case UTF8_WRONG:
+	    sprintf(temp, "*** %d columns, expected %d",
+		    moved, UTF8_REPEAT * p->width);
+	    break;
+	default:
+	    strcpy(temp, "*** no cursor position report");
+	    break;
+	}
+	put_str(temp);
+	put_crlf();
+    }
+    put_crlf();
+    ptextln("If the cursor moved one column for each byte, the terminal is not set to UTF-8.");
+    generic_done_message(t, state, ch);
+}
+
+/*
+**	utf8_run(test_list, sample)
+**
+**	Fill the screen with copies of the sample until the test time runs
+**	out.  Return the number of copies written.
+*/
+static int
+utf8_run(
+	    TestList * t,
+	    const Utf8Sample * p)
+{
+    int copies = 0;
+    /* stop short of the margin, to avoid the wrap glitches */
+    int per_row = (columns - 1) / p->width;
+
+    pad_test_startup(1);
+    /* the model counts bytes, not characters */
+    model_forget();
+    do {
+	int row, n;
+
+	go_home();
+	for (row = 0; row < lines - 1; row++) {
+	    for (n = 0; n < per_row; n++) {
+		put_utf8(p->text);
+		copies++;
+	    }
+	    put_crlf();
+	    SLOW_TERMINAL_EXIT;
+	}
+    } while (still_testing());
+    pad_test_shutdown(t, 0);
+    return copies;
+}
+
+/*
+**	utf8_throughput(test_list, status, ch)
+**
+**	Time the output of each sample, and report the glyphs and bytes per
+**	second.  The cursor advance is checked before each sample is timed.
+*/
+static void
+utf8_throughput(
+		   TestList * t,
+		   int *state,
+		   int *ch)
+{
+    static const char *check_name[] =
+    {
+	"-",
+	"ok",
+	"wrong"
+    };
+    int copies[NUM_SAMPLES];
+    int bytes[NUM_SAMPLES];
+    int check[NUM_SAMPLES];
+    unsigned long usec[NUM_SAMPLES];
+    int n, moved;
+
+    if (skip_pad_test(t, state, ch, "Start UTF-8 throughput test")) {
+	return;
+    }
+    for (n = 0; n < NUM_SAMPLES; n++) {
+	put_crlf();
+	check[n] = utf8_check(&utf8_samples[n], &moved);
+	copies[n] = utf8_run(t, &utf8_samples[n]);
+	usec[n] = usec_run_time;
+	bytes[n] = tx_characters;
+    }
+    put_clear();
+    ptextln("                glyphs/sec   bytes/sec bytes/glyph  cursor");
+    for (n = 0; n < NUM_SAMPLES; n++) {
+	const Utf8Sample *p = &utf8_samples[n];
+	unsigned long divisor = usec[n] ? usec[n] : 1;
+	int glyphs = copies[n] * p->glyphs;
+	int hundredths = sliding_scale(bytes[n], 100,
+				       (unsigned long) (glyphs ? glyphs : 1));
+
+	sprintf(temp, "%-12s %13lu %11lu %8d.%02d  %s",
+		p->name,
+		(unsigned long) sliding_scale(glyphs, 1000000, divisor),
+		(unsigned long) sliding_scale(bytes[n], 1000000, divisor),
+		hundredths / 100, hundredths % 100,
+		check_name[check[n]]);
+	ptextln(temp);
+    }
+    put_crlf();
+    pad_done_message(t, state, ch);
+}
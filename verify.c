@@ -0,0 +1,319 @@
+/*
+** Copyright 2026 Thomas E. Dickey
+**
+** This file is part of TACK.
+**
+** TACK is free software; you can redistribute it and/or modify
+** it under the terms of the GNU General Public License as published by
+** the Free Software Foundation, version 2.
+**
+** TACK is distributed in the hope that it will be useful,
+** but WITHOUT ANY WARRANTY; without even the implied warranty of
+** MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+** GNU General Public License for more details.
+**
+** You should have received a copy of the GNU General Public License
+** along with TACK; see the file COPYING.  If not, write to
+** the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor,
+** Boston, MA 02110-1301, USA
+*/
+
+
+#include <tack.h>
+
+MODULE_ID("$Id: verify.c,v 1.1 2026/10/19 00:00:00 tom Exp $")
+
+/*
+ * Check the screen after a pad test, rather than asking the user to look.
+ *
+ * The cursor position is asked for with the user7 (u7) string, and the
+ * reply is decoded with the user6 (u6) format.  If the terminal supports
+ * DECRQCRA, the checksum of the screen is asked for as well, and compared
+ * with the checksum of the layout which the test should have drawn.
+ *
+ * Terminals do not agree on the checksum: some report the negated sum of
+ * the characters, and some count an erased cell as a blank while others
+ * count it as zero.  When verification is enabled, tack writes a sample
+ * on a cleared screen at startup, and learns which is used.
+ */
+
+#define CKSUM_NONE	0	/* not calibrated, or the terminal does not reply */
+#define CKSUM_READY	1	/* calibrated */
+
+#define CKSUM_SAMPLE	"Tk"
+
+int verify_mode;		/* TRUE to check the screen after pad tests */
+
+static int cksum_state = CKSUM_NONE;
+static int cksum_negate;	/* TRUE if the sum is negated */
+static int cksum_erased;	/* value of an erased cell */
+
+/*
+**	parse_u6(format, reply, row, col)
+**
+**	Decode a cursor position report with the user6 (u6) format.
+**	Return TRUE if the reply matches.
+*/
+static int
+parse_u6(
+	    const char *format,
+	    const char *reply,
+	    int *row,
+	    int *col)
+{
+    int value[2];
+    int count = 0;
+    int origin = 0;
+
+    while (*format != '\0') {
+	if (*format == '%') {
+	    switch (*++format) {
+	    case 'i':
+		origin = 1;
+		break;
+	    case 'd':
+		if (count >= 2 || !isdigit(UChar(*reply))) {
+		    return FALSE;
+		}
+		for (value[count] = 0; isdigit(UChar(*reply)); reply++) {
+		    value[count] = (value[count] * 10) + (*reply - '0');
+		}
+		count++;
+		break;
+	    case '%':
+		if (*reply++ != '%') {
+		    return FALSE;
+		}
+		break;
+	    default:
+		return FALSE;
+	    }
+	    format++;
+	} else if (*format++ != *reply++) {
+	    return FALSE;
+	}
+    }
+    if (count != 2) {
+	return FALSE;
+    }
+    *row = value[0] - origin;
+    *col = value[1] - origin;
+    return TRUE;
+}
+
+/*
+**	verify_cursor(row, col)
+**
+**	Ask the terminal where the cursor is.  Return TRUE if it answers.
+*/
+int
+verify_cursor(
+		 int *row,
+		 int *col)
+{
+    char reply[TEMP_SIZE];
+    const char *s;
+    int active;
+
+    if (!VALID_STRING(user7) || !VALID_STRING(user6)) {
+	return FALSE;
+    }
+    active = model_suspend();
+    tc_putp(user7);
+    model_resume(active);
+    (void) read_reply(reply, sizeof(reply) - 1);
+    for (s = reply; *s != '\0'; s++) {
+	if (parse_u6(user6, s, row, col)) {
+	    return TRUE;
+	}
+    }
+    return FALSE;
+}
+
+/*
+**	request_checksum(top, left, bottom, right, value)
+**
+**	Ask for the checksum of a rectangle (DECRQCRA), with zero-based
+**	inclusive limits.  Return TRUE if the terminal answers.
+*/
+static int
+request_checksum(
+		    int top,
+		    int left,
+		    int bottom,
+		    int right,
+		    unsigned *value)
+{
+    char request[80];
+    char reply[TEMP_SIZE];
+    const char *s;
+    int active;
+
+    sprintf(request, "\033[1;1;%d;%d;%d;%d*y",
+	    top + 1, left + 1, bottom + 1, right + 1);
+    /* the request does not change the screen */
+    active = model_suspend();
+    tc_putp(request);
+    model_resume(active);
+    (void) read_reply(reply, sizeof(reply) - 1);
+    if ((s = strstr(reply, "!~")) != NULL
+	&& sscanf(s + 2, "%4x", value) == 1) {
+	return TRUE;
+    }
+    return FALSE;
+}
+
+/*
+**	cksum_result(sum)
+**
+**	Return the checksum which the terminal would report for a sum of
+**	cell values.
+*/
+static unsigned
+cksum_result(
+		unsigned sum)
+{
+    return (cksum_negate ? (0U - sum) : sum) & 0xffff;
+}
+
+/*
+**	verify_init()
+**
+**	Start the screen model, and learn how the terminal computes DECRQCRA
+**	checksums, using a sample written on a cleared screen.  The screen is
+**	cleared again.
+*/
+void
+verify_init(void)
+{
+    unsigned sum = 0, value;
+    const char *s;
+
+    model_start();
+    cksum_state = CKSUM_NONE;
+    put_clear();
+    put_str(CKSUM_SAMPLE);
+    for (s = CKSUM_SAMPLE; *s != '\0'; s++) {
+	sum += UChar(*s);
+    }
+    if (request_checksum(0, 0, 0, (int) strlen(CKSUM_SAMPLE) - 1, &value)) {
+	if (value == ((0U - sum) & 0xffff)) {
+	    cksum_negate = TRUE;
+	    cksum_state = CKSUM_READY;
+	} else if (value == sum) {
+	    cksum_negate = FALSE;
+	    cksum_state = CKSUM_READY;
+	}
+    }
+    if (cksum_state == CKSUM_READY
+	&& request_checksum(0, columns - 1, 0, columns - 1, &value)) {
+	if (value == cksum_result((unsigned) ' ')) {
+	    cksum_erased = ' ';
+	} else if (value == 0) {
+	    cksum_erased = 0;
+	} else {
+	    cksum_state = CKSUM_NONE;
+	}
+    }
+    put_clear();
+}
+
+/*
+**	expected_checksum(grid, top, bottom)
+**
+**	Compute the checksum for rows of the expected layout.
+*/
+static unsigned
+expected_checksum(
+		     const char *grid,
+		     int top,
+		     int bottom)
+{
+    unsigned sum = 0;
+    int row, col;
+
+    for (row = top; row <= bottom; row++) {
+	for (col = 0; col < columns; col++) {
+	    int ch = UChar(grid[(row * columns) + col]);
+
+	    sum += (unsigned) (ch ? ch : cksum_erased);
+	}
+    }
+    return cksum_result(sum);
+}
+
+/*
+**	verify_screen(test_list, row, col, grid)
+**
+**	After a pad test, compare the cursor position and the screen with
+**	what the test should have drawn.  The grid holds lines * columns
+**	characters, with zero for an erased cell; it may be null if only the
+**	cursor is known.  A row or column of -1 is not checked.  The result
+**	is shown after the test, and in batch mode also written to the
+**	standard error.  Return VERIFY_FAILED if either differs.
+*/
+int
+verify_screen(
+		 TestList * t,
+		 int row,
+		 int col,
+		 const char *grid)
+{
+    char text[TEMP_SIZE];
+    int result = VERIFY_UNKNOWN;
+    int got_row, got_col;
+    unsigned value;
+
+    if (!verify_mode) {
+	return VERIFY_UNKNOWN;
+    }
+    text[0] = '\0';
+    if (row >= 0 && verify_cursor(&got_row, &got_col)) {
+	if (got_row == row && (col < 0 || got_col == col)) {
+	    strcpy(text, "cursor ok");
+	    result = VERIFY_OK;
+	} else {
+	    sprintf(text, "cursor at %d,%d not %d,%d",
+		    got_row, got_col, row, col);
+	    result = VERIFY_FAILED;
+	}
+    }
+    if (grid != NULL) {
+	if (cksum_state == CKSUM_READY
+	    && request_checksum(0, 0, lines - 1, columns - 1, &value)) {
+	    strcat(text, text[0] ? ", " : "");
+	    if (value == expected_checksum(grid, 0, lines - 1)) {
+		strcat(text, "screen ok");
+		if (result == VERIFY_UNKNOWN) {
+		    result = VERIFY_OK;
+		}
+	    } else {
+		int n;
+
+		/* find the first row which differs */
+		for (n = 0; n < lines; n++) {
+		    if (request_checksum(n, 0, n, columns - 1, &value)
+			&& value != expected_checksum(grid, n, n)) {
+			break;
+		    }
+		}
+		if (n < lines) {
+		    sprintf(text + strlen(text), "screen differs at row %d", n);
+		} else {
+		    strcat(text, "screen differs");
+		}
+		result = VERIFY_FAILED;
+	    }
+	}
+    }
+    if (text[0] != '\0') {
+	if (batch_mode) {
+	    fprintf(stderr, "%-16s verify  %s\n",
+		    t->caps_done ? t->caps_done : "?", text);
+	}
+	strcat(text, ".  ");
+	text[0] = (char) toupper(UChar(text[0]));
+	ptext(text);
+    }
+    return result;
+}